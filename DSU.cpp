@@ -2,4 +2,3 @@
 
 
 bool DSU::EnableMetrics = false;
-bool DSU::EnableCompaction = true;
@@ -3,6 +3,11 @@
 
 #include "lib/numa.hpp"
 #include "lib/metrics.hpp"
+#include "lib/frozen_labels.hpp"
+#include "lib/gather_same_set.hpp"
+#include "lib/node_partition.hpp"
+#include "lib/wait_policy.hpp"
+#include "lib/compaction.hpp"
 
 #include <sched.h>
 #include <thread>
@@ -10,49 +15,170 @@
 #include <vector>
 #include <numa.h>
 #include <mutex>
+#include <memory>
+#include <utility>
+#include <span>
+
+struct UnionResult {
+    bool merged; // false if u and v were already in the same set
+    int root;    // root of the united set right after the operation
+};
 
 class DSU : public MetricsAwareBase {
 public:
     static bool EnableMetrics;
-    static bool EnableCompaction;
 
     explicit DSU(NUMAContext* ctx, [[maybe_unused]] size_t numThreads = 0)
-            : MetricsAwareBase(EnableMetrics ? std::max(numThreads, (size_t)std::thread::hardware_concurrency()) : 0)
+            : MetricsAwareBase(EnableMetrics ? std::max({numThreads, (size_t)std::thread::hardware_concurrency(), ctx ? ctx->MaxConcurrency() : 0}) : 0)
             , Ctx_(ctx) {}
 
     DSU()
         : DSU(nullptr) {}
 
     virtual std::string ClassName() = 0;
+    virtual int Size() const = 0;
     virtual void ReInit() = 0;
     virtual void DoUnion(int u, int v) = 0;
     virtual int Find(int u) = 0;
     virtual bool DoSameSet(int u, int v) = 0;
+    // the calling thread joins the set of threads working with the DSU; threads also join on their first operation
+    virtual void Register() {}
+    // the calling thread leaves until its next operation
     virtual void GoAway() {}
+    // starts or stops background compaction by low-priority service threads; no-op if the implementation has none
+    virtual void SetCompactionDaemon([[maybe_unused]] bool enabled) {}
     virtual ~DSU() = default;
 
+    /*
+     * Roots of u and v in one call; implementations share the common part of the traversals.
+     * The roots are consistent with each other only if no union runs concurrently.
+     */
+    virtual std::pair<int, int> FindPair(int u, int v) {
+        return {Find(u), Find(v)};
+    }
+
+    // not atomic by default: a concurrent union may merge the sets between the steps
+    virtual UnionResult DoTryUnion(int u, int v) {
+        auto [ru, rv] = FindPair(u, v);
+        if (ru == rv)
+            return {false, ru};
+        DoUnion(ru, rv);
+        return {true, Find(ru)};
+    }
+
+    /*
+     * Unites all the given pairs in parallel on the worker threads of the context (WorkerCount()),
+     * each of which goes away when done. Implementations may replace it with an offline algorithm;
+     * the result must be the same sets. Must be called outside of the worker threads.
+     */
+    virtual void BulkBuild(std::span<const VertexPair> edges) {
+        REQUIRE(Ctx_, "BulkBuild requires NUMA context");
+        REQUIRE(!IsFrozen(), "BulkBuild of a frozen DSU; call Thaw() first");
+        int numThreads = (int) Ctx_->WorkerCount();
+        Ctx_->StartNThreads([this, edges, numThreads]() {
+            auto [begin, end] = NodePartition::Split(0, (int) edges.size(), NUMAContext::CurrentThreadId(), numThreads);
+            for (int i = begin; i < end; ++i) {
+                Union(edges[i].u, edges[i].v);
+            }
+            GoAway();
+        }, numThreads);
+        Ctx_->Join();
+    }
+
+    // answers queries one by one; implementations may batch them
+    virtual void DoBulkSameSet(std::span<const VertexPair> queries, uint64_t* result) {
+        for (size_t i = 0; i < queries.size(); i += 64) {
+            size_t m = std::min<size_t>(64, queries.size() - i);
+            uint64_t word = 0;
+            for (size_t j = 0; j < m; ++j) {
+                word |= static_cast<uint64_t>(SameSet(queries[i + j].u, queries[i + j].v)) << j;
+            }
+            result[i / 64] = word;
+        }
+    }
+
+    /*
+     * Compresses every vertex to its root and switches the DSU to read-only mode:
+     * SameSet is answered by two loads from the node-local replica of the labels.
+     * Union of two different sets is forbidden until Thaw().
+     * Must be called outside of the worker threads.
+     */
+    void Freeze(bool denseLabels = false) {
+        REQUIRE(Ctx_, "Freeze requires NUMA context");
+        Thaw();
+        auto labels = std::make_unique<FrozenLabels>(Ctx_, Size());
+        labels->Build([this](int u) { return Find(u); }, denseLabels);
+        Frozen_ = std::move(labels);
+    }
+
+    void Thaw() {
+        Frozen_.reset();
+    }
+
+    bool IsFrozen() const {
+        return static_cast<bool>(Frozen_);
+    }
+
+    // how the threads wait for each other inside operations; must not be changed while operations run
+    void SetWaitPolicy(WaitPolicy policy) {
+        WaitPolicy_ = policy;
+    }
+
+    WaitPolicy GetWaitPolicy() const {
+        return WaitPolicy_;
+    }
+
+    // path compaction of this instance; must not be changed while operations run
+    virtual void SetCompaction(CompactionPolicy policy) {
+        Compaction_ = policy;
+    }
+
+    CompactionPolicy GetCompaction() const {
+        return Compaction_;
+    }
+
+    const FrozenLabels* Frozen() const {
+        return Frozen_.get();
+    }
+
+    /*
+     * Bit i of `result` is SameSet(queries[i]); `result` must hold (queries.size() + 63) / 64 words.
+     * A frozen DSU answers with a vectorised gather over the node-local labels.
+     */
+    void BulkSameSet(std::span<const VertexPair> queries, uint64_t* result, GatherKernel kernel = GatherKernel::Auto) {
+        if (Frozen_) {
+            GatherSameSet(Frozen_->NodeLabels(NUMAContext::CurrentThreadNode()), queries, result, kernel);
+            return;
+        }
+        DoBulkSameSet(queries, result);
+    }
+
     void Union(int u, int v) {
-        size_t beforeOpCNRead = mCrossNodeRead.get();
-        size_t beforeOpCNWrite = mCrossNodeWrite.get();
-        size_t beforeOpGlobal = mGlobalDataAccess.get();
-        size_t beforeOpCNAll = beforeOpCNRead + beforeOpCNWrite + beforeOpGlobal;
+        if (Frozen_) {
+            VERIFY(Frozen_->SameSet(u, v, NUMAContext::CurrentThreadNode()),
+                   "Union of different sets in a frozen DSU; call Thaw() first");
+            return;
+        }
 
+        AccessCounts before = accessCounts();
         DoUnion(u, v);
+        recordUnion(before);
+    }
 
-        if (EnableMetrics) {
-            size_t afterOpCNRead = mCrossNodeRead.get();
-            size_t afterOpCNWrite = mCrossNodeWrite.get();
-            size_t afterOpGlobal = mGlobalDataAccess.get();
-            size_t afterOpCNAll = afterOpCNRead + afterOpCNWrite + afterOpGlobal;
-            mHistCrossNodeRead.inc(afterOpCNRead - beforeOpCNRead);
-            mHistCrossNodeWrite.inc(afterOpCNWrite - beforeOpCNWrite);
-            mHistAllCrossNodeAccess.inc(afterOpCNAll - beforeOpCNAll);
-            mUnionRequests.inc(1);
-
-            mCrossNodeReadInUnion.inc(afterOpCNRead - beforeOpCNRead);
-            mCrossNodeWriteInUnion.inc(afterOpCNWrite - beforeOpCNWrite);
-            mGlobalDataAccessInUnion.inc(afterOpGlobal - beforeOpGlobal);
+    /*
+     * Union which tells whether the sets were different, so callers need no SameSet/Find beforehand.
+     */
+    UnionResult TryUnion(int u, int v) {
+        if (Frozen_) {
+            VERIFY(Frozen_->SameSet(u, v, NUMAContext::CurrentThreadNode()),
+                   "Union of different sets in a frozen DSU; call Thaw() first");
+            return {false, Find(u)};
         }
+
+        AccessCounts before = accessCounts();
+        UnionResult r = DoTryUnion(u, v);
+        recordUnion(before);
+        return r;
     }
 
     bool SameSet(int u, int v) {
@@ -60,7 +186,8 @@ public:
         size_t beforeOpCNWrite = mCrossNodeWrite.get();
         size_t beforeOpGlobal = mGlobalDataAccess.get();
         size_t beforeOpCNAll = beforeOpCNRead + beforeOpCNWrite + beforeOpGlobal;
-        bool r = DoSameSet(u, v);
+        // the frozen path makes no cross-node accesses but is counted all the same
+        bool r = Frozen_ ? Frozen_->SameSet(u, v, NUMAContext::CurrentThreadNode()) : DoSameSet(u, v);
 
         if (EnableMetrics) {
             size_t afterOpCNRead = mCrossNodeRead.get();
@@ -89,7 +216,14 @@ public:
     }
 
 protected:
+    // for implementations without their own controller
+    bool CompactPaths() const {
+        return Compaction_ != CompactionPolicy::None;
+    }
+
     NUMAContext* Ctx_;
+    WaitPolicy WaitPolicy_ = WaitPolicy::Spin;
+    CompactionPolicy Compaction_ = CompactionPolicy::Full;
     MetricsCollector::Accessor mCrossNodeRead = accessor("cross_node_read");
     MetricsCollector::Accessor mCrossNodeWrite = accessor("cross_node_write");
     MetricsCollector::Accessor mThisNodeRead = accessor("this_node_read");
@@ -102,6 +236,36 @@ protected:
     MetricsCollector::HistAccessor mHistFindDepth = histogram("hist_find_depth", 500);
 
 private:
+    struct AccessCounts {
+        size_t crossNodeRead = 0;
+        size_t crossNodeWrite = 0;
+        size_t global = 0;
+    };
+
+    AccessCounts accessCounts() const {
+        return {mCrossNodeRead.get(), mCrossNodeWrite.get(), mGlobalDataAccess.get()};
+    }
+
+    // shared by Union and TryUnion
+    void recordUnion(const AccessCounts& before) {
+        if (!EnableMetrics)
+            return;
+        AccessCounts after = accessCounts();
+        size_t read = after.crossNodeRead - before.crossNodeRead;
+        size_t write = after.crossNodeWrite - before.crossNodeWrite;
+        size_t global = after.global - before.global;
+        mHistCrossNodeRead.inc(read);
+        mHistCrossNodeWrite.inc(write);
+        mHistAllCrossNodeAccess.inc(read + write + global);
+        mUnionRequests.inc(1);
+
+        mCrossNodeReadInUnion.inc(read);
+        mCrossNodeWriteInUnion.inc(write);
+        mGlobalDataAccessInUnion.inc(global);
+    }
+
+    std::unique_ptr<FrozenLabels> Frozen_;
+
     MetricsCollector::Accessor mSameSetRequestsTrue = accessor("same_set_requests_true");
     MetricsCollector::Accessor mSameSetRequestsFalse = accessor("same_set_requests_false");
     MetricsCollector::Accessor mUnionRequests = accessor("union_requests");
@@ -121,6 +285,24 @@ private:
     MetricsCollector::Accessor mGlobalDataAccessInUnion = accessor("global_data_read_write_in_union");
 };
 
+/*
+ * Implementations that keep every vertex on its home node. Owners are set after ReInit() and before
+ * the first operation; by default every vertex belongs to node 0.
+ */
+class OwnershipAware {
+public:
+    virtual void SetOwner(int v, int node) = 0;
+
+    // owners[v] is the home node of v
+    virtual void SetOwners(std::span<const int> owners) {
+        for (int v = 0; v < (int) owners.size(); ++v) {
+            SetOwner(v, owners[v]);
+        }
+    }
+
+    virtual ~OwnershipAware() = default;
+};
+
 
 // utility for adaptive implementations
 
@@ -135,4 +317,4 @@ static constexpr std::array<int, 1 << maxNumaNodes> makeOwnerLookupTable() {
     return res;
 }
 
-#endif //TRY_DSU_H
\ No newline at end of file
+#endif //TRY_DSU_H
\ No newline at end of file
@@ -3,23 +3,17 @@
 #include "lib/graphs.h"
 #include "lib/csv.hpp"
 #include "lib/hist_csv.hpp"
+#include "lib/timeline.hpp"
+#include "lib/metric_series.hpp"
 #include "lib/parameters.hpp"
 #include "lib/benchmark.hpp"
 #include "lib/workload_provider.hpp"
+#include "lib/dsu_registry.hpp"
 
 #include "DSU.h"
-#include "implementations/DSU_ParallelUnions.h"
-#include "implementations/DSU_ParallelUnions_no_imm.h"
-#include "implementations/DSU_Usual.h"
-#include "implementations/DSU_Usual_noimm.h"
-#include "implementations/DSU_Adaptive.h"
-#include "implementations/DSU_AdaptiveSmart.h"
-#include "implementations/DSU_AdaptiveLocks.h"
-#include "implementations/DSU_LazyUnion.h"
-#include "implementations/DSU_WireHelping.h"
-#include "implementations/SeveralDSU.h"
 
 #include "workloads/components_v2.hpp"
+#include "workloads/skewed_merge.hpp"
 
 #include <CLI/App.hpp>
 #include <CLI/Formatter.hpp>
@@ -30,116 +24,265 @@
 #include <thread>
 #include <regex>
 #include <algorithm>
+#include <map>
+#include <set>
+
+
+/*
+ * Applies per-run (or per-stage) parameters to the DSU right before the measured run.
+ */
+void ApplyRunParameters(DSU* dsu, const ParameterSet& params) {
+    dsu->SetCompaction(ParseCompactionPolicy(params.Get<std::string>("compact")));
+    dsu->SetWaitPolicy(ParseWaitPolicy(params.Get<std::string>("wait")));
+    dsu->SetCompactionDaemon(params.Get<bool>("daemon"));
+    if (params.Get<bool>("freeze")) {
+        dsu->Freeze();
+    } else {
+        dsu->Thaw();
+    }
+}
 
+// stops what ApplyRunParameters started in the background, so it does not run while other DSUs are measured
+void FinishRun(DSU* dsu) {
+    dsu->SetCompactionDaemon(false);
+}
 
-std::vector<std::unique_ptr<DSU>> GetAvailableDsus(NUMAContext* ctx, size_t N, const std::regex& filter) {
-    std::vector<std::unique_ptr<DSU>> dsus;
 
-    dsus.emplace_back(new DSU_Usual(N));
-    dsus.emplace_back(new SeveralDSU(ctx, N));
+// worker threads of the run and their CPUs; must precede both the DSU construction and the workload
+void ApplyWorkers(NUMAContext* ctx, const ParameterSet& params) {
+    ctx->SetWorkers(params.Get<size_t>("threads"), ParseThreadPlacement(params.Get<std::string>("placement")));
+}
 
-    auto construct = [&]<class T> (T) {
-        dsus.emplace_back(new DSU_ParallelUnions<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_Adaptive<T::value, false>(ctx, N));
-        dsus.emplace_back(new DSU_Adaptive<T::value, true>(ctx, N));
-        dsus.emplace_back(new DSU_AdaptiveLocks<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_AdaptiveSmart<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_LazyUnions<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_WireHelping<T::value, false>(ctx, N));
-    };
 
-    construct(std::true_type{});
-    construct(std::false_type{});
+// CSV parameter columns: the workload parameters followed by the run parameters that change the score
+std::vector<std::string> ResultParameterNames(const WorkloadProvider* wlProvider) {
+    std::vector<std::string> names = wlProvider->GetParameterNames();
+    for (const char* name : {"threads", "placement", "duration_ms", "rate", "work",
+                             "compact", "wait", "daemon", "freeze", "bulk_preheat", "sample_latency"}) {
+        names.emplace_back(name);
+    }
+    return names;
+}
 
 
-    //dsus.emplace_back(new DSU_Usual_NoImm(N));
+// distinct CPUs taken by the worker threads
+size_t WorkerCores(const NUMAContext* ctx) {
+    std::set<int> cpus;
+    for (int tid = 0; tid < (int) ctx->WorkerCount(); ++tid) {
+        cpus.insert(ctx->CpuForThread(tid));
+    }
+    return cpus.size();
+}
 
-    //dsus.emplace_back(new TwoDSU(N, node_count));
-    //dsus.emplace_back(new DSU_ParallelUnions_NoImm(N, node_count));
 
-//    dsus.emplace_back(new DSU_NO_SYNC(N, node_count));
-    //dsus.emplace_back(new DSU_NO_SYNC_NoImm(N, node_count));
+/*
+ * Scores of a scalability run: the makespan throughput of every result is divided by the single-thread score
+ * of the same DSU and by the best single-thread score among all DSUs, both with otherwise equal parameters,
+ * and by the score of the sequential baseline on the same parameter set, if it was run.
+ * Parameter sets are told apart by the values of the CSV columns.
+ */
+class SpeedupTable {
+public:
+    explicit SpeedupTable(std::vector<std::string> columns)
+        : Columns_(std::move(columns))
+    {}
+
+    void Add(const std::string& name, const ParameterSet& params, const Stats<double>& makespanThroughput,
+             size_t cores) {
+        Row row{name, values(params), {}, params.Get<size_t>("threads"), cores, makespanThroughput};
+        for (size_t i = 0; i < Columns_.size(); ++i) {
+            // placement does not matter for a single thread
+            row.Key.push_back(Columns_[i] == "threads" || Columns_[i] == "placement" ? "" : row.Values[i]);
+        }
+        Rows_.push_back(std::move(row));
+    }
 
-//    dsus.emplace_back(new DSU_Parts(N, node_count, owners));
-    //dsus.emplace_back(new DSU_Parts_NoImm(N, node_count, owners));
+    // total throughput of DSU_Sequential
+    void SetSequential(const ParameterSet& params, const Stats<double>& score) {
+        Sequential_[values(params)] = score.mean;
+    }
 
-//    dsus.emplace_back(new DSU_NoSync_Parts(N, node_count, owners));
-    //dsus.emplace_back(new DSU_NoSync_Parts_NoImm(N, node_count, owners));
+    void Write(CsvFile& out) const {
+        for (const Row& row : Rows_) {
+            double own = 0, best = 0;
+            for (const Row& base : Rows_) {
+                if (base.Threads != 1 || base.Key != row.Key)
+                    continue;
+                best = std::max(best, base.Score.mean);
+                if (base.Name == row.Name)
+                    own = base.Score.mean;
+            }
+            auto sequential = Sequential_.find(row.Values);
+            double sequentialScore = sequential == Sequential_.end() ? 0 : sequential->second;
+            for (auto [suffix, baseline] : std::array{std::pair{":speedup", own},
+                                                      std::pair{":speedup_vs_best_single_thread", best},
+                                                      std::pair{":speedup_vs_sequential", sequentialScore}}) {
+                if (baseline <= 0)
+                    continue;
+                std::cout << std::fixed << std::setprecision(3)
+                          << row.Name << suffix << ": " << row.Score.mean / baseline << std::endl;
+                auto writer = out << (row.Name + suffix);
+                for (const std::string& value : row.Values) {
+                    writer << value;
+                }
+                writer << row.Score.mean / baseline << row.Score.stddev / baseline;
+            }
 
+            auto writer = out << (row.Name + ":cores");
+            for (const std::string& value : row.Values) {
+                writer << value;
+            }
+            writer << row.Cores << 0;
+        }
+    }
 
-    auto end = std::remove_if(dsus.begin(), dsus.end(), [&filter](const std::unique_ptr<DSU>& dsu) {
-        return !std::regex_match(dsu->ClassName(), filter);
-    });
-    dsus.resize(end - dsus.begin());
-    return dsus;
+private:
+    struct Row {
+        std::string Name;
+        std::vector<std::string> Values; // CSV columns
+        std::vector<std::string> Key;    // CSV columns except threads and placement
+        size_t Threads;
+        size_t Cores;
+        Stats<double> Score; // makespan throughput
+    };
+
+    std::vector<std::string> values(const ParameterSet& params) const {
+        std::vector<std::string> result;
+        for (const std::string& column : Columns_) {
+            result.push_back(params.Get<std::string>(column));
+        }
+        return result;
+    }
+
+    std::vector<std::string> Columns_;
+    std::vector<Row> Rows_;
+    std::map<std::vector<std::string>, double> Sequential_;
+};
+
+
+// name of the DSU in the results; routed, devirtualized and SoA runs are reported separately
+std::string ResultName(DSU* dsu, const ParameterSet& params) {
+    return dsu->ClassName() + (params.Get<bool>("routing") ? "/routed" : "")
+        + (params.Get<bool>("devirt") ? "/devirt" : "")
+        + (ParseRequestLayout(params.Get<std::string>("layout")) == RequestLayout::SoA ? "/soa" : "");
 }
 
-void PrepareDSUForWorkload(DSU* dsu, const StaticWorkload& workload) {
-    dsu->ReInit();
-
-    // FIXME This is a hack to test the conjecture.
-    PrepareDSUForWorkload<DSU_Adaptive<false, false>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<true, false>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<false, true>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<true, true>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveLocks<false>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveLocks<true>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveSmart<false>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveSmart<true>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_WireHelping<false, false>>(dsu, workload);
-    PrepareDSUForWorkload<DSU_WireHelping<true, false>>(dsu, workload);
+
+// how Benchmark::Run applies the requests
+void ApplyBenchmarkParameters(Benchmark& benchmark, const ParameterSet& params) {
+    benchmark.SetRouting(params.Get<bool>("routing"));
+    benchmark.SetRequestLayout(ParseRequestLayout(params.Get<std::string>("layout")));
+    benchmark.SetDuration(std::chrono::milliseconds(params.Get<size_t>("duration_ms")));
+    benchmark.SetBulkPreheat(params.Get<bool>("bulk_preheat"));
+    benchmark.SetLatencySampling(params.Get<bool>("sample_latency"));
+    // at a low rate an open-loop run would otherwise pace through the whole workload
+    REQUIRE(params.Get<double>("rate") <= 0 || params.Get<size_t>("duration_ms") > 0,
+            "An open-loop run (rate > 0) needs duration_ms");
+    benchmark.SetArrivalRate(params.Get<double>("rate"));
+    benchmark.SetAdditionalWork(params.Get<double>("work"));
 }
 
 
-void RunBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& outH, const std::regex& filter,
-                  size_t numWorkloads, size_t numIterationsPerWorkload,
-                  WorkloadProvider* wlProvider, const std::vector<ParameterSet>& parameters) {
+/*
+ * Unless `sequentialBaseline` is false, every workload of a closed-loop run is also run by the Devirtualized
+ * DSU_Sequential on a single thread (see Benchmark::RunSequential), and the results are compared with it.
+ * Thread timelines of the measured runs go to `outTimelines` if it is set, and metric time series sampled
+ * every `samplingPeriod` go to `outSeries` if it is set.
+ */
+void RunBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& outH, TimelineCsvFile* outTimelines,
+                  SeriesCsvFile* outSeries, std::chrono::milliseconds samplingPeriod,
+                  const std::regex& filter, size_t numWorkloads, size_t numIterationsPerWorkload,
+                  WorkloadProvider* wlProvider, const std::vector<ParameterSet>& parameters,
+                  bool sequentialBaseline) {
+    const std::vector<std::string> columns = ResultParameterNames(wlProvider);
     { // write CSV header
         auto writer = out << "DSU";
-        for (const std::string& param : wlProvider->GetParameterNames()) {
+        for (const std::string& param : columns) {
             writer << param;
         }
         writer << "Score" << "Score Error";
     }
 
-    Benchmark benchmark(ctx); // TODO pass additional work
+    Benchmark benchmark(ctx);
+    if (outSeries)
+        benchmark.SetSamplingPeriod(samplingPeriod);
+    SpeedupTable speedups(columns);
     for (const auto& params : parameters) {
-        std::vector<std::unique_ptr<DSU>> dsus = GetAvailableDsus(ctx, params.Get<size_t>("N"), filter);
+        // the DSU is frozen right after ReInit, i.e. with every vertex in its own set
+        REQUIRE(!params.Get<bool>("freeze"), "freeze=true is for the later stages of a staged run");
+        ApplyWorkers(ctx, params);
+        std::vector<std::unique_ptr<DSU>> dsus = GetAvailableDsus(ctx, params.Get<size_t>("N"), filter,
+                                                                  params.Get<bool>("devirt"));
         if (dsus.empty())
             continue;
+        ApplyBenchmarkParameters(benchmark, params);
+        std::unique_ptr<DSU> sequential;
+        // the baseline applies every request once as fast as it can, so fixed-duration and open-loop runs have none
+        bool closedLoop = params.Get<size_t>("duration_ms") == 0 && params.Get<double>("rate") <= 0;
+        if (sequentialBaseline && closedLoop)
+            sequential = GetSequentialVariant().MakeDevirtualized(ctx, params.Get<size_t>("N"));
 
         for (size_t i = 0; i < numWorkloads; ++i) {
             std::cout << "Preparing workload #" << i << std::endl;
             StaticWorkload workload = wlProvider->MakeWorkload(ctx, params);
+            if (sequential) {
+                if (i == 0) {
+                    PrepareDSUForWorkload(sequential.get(), workload);
+                    std::cout << "Warmup iteration for workload #" << i << "; sequential baseline" << std::endl;
+                    benchmark.RunSequential(sequential.get(), workload, true);
+                }
+                for (size_t j = 0; j < numIterationsPerWorkload; ++j) {
+                    PrepareDSUForWorkload(sequential.get(), workload);
+                    std::cout << "Benchmark iteration #" << j << " for workload #" << i << "; sequential baseline"
+                              << std::endl;
+                    benchmark.RunSequential(sequential.get(), workload);
+                }
+            }
             for (auto& ptr: dsus) {
                 DSU* dsu = ptr.get();
 
                 if (i == 0) {
                     PrepareDSUForWorkload(dsu, workload);
-                    DSU::EnableCompaction = params.Get<bool>("compact");
+                    ApplyRunParameters(dsu, params);
 
                     // warmup for the given parameter set
                     std::cout << "Warmup iteration for workload #" << i << "; DSU " << dsu->ClassName() << std::endl;
                     benchmark.Run(dsu, workload, true);
+                    FinishRun(dsu);
                 }
 
                 for (size_t j = 0; j < numIterationsPerWorkload; ++j) {
                     PrepareDSUForWorkload(dsu, workload);
-                    DSU::EnableCompaction = params.Get<bool>("compact");
+                    ApplyRunParameters(dsu, params);
 
                     std::cout << "Benchmark iteration #" << j << " for workload #" << i << "; DSU " << dsu->ClassName()
                               << std::endl;
                     benchmark.Run(dsu, workload);
+                    FinishRun(dsu);
                 }
             }
         }
+        if (sequential) {
+            Stats<double> result = benchmark.CollectThroughputStats(sequential.get());
+            std::cout << std::fixed << std::setprecision(3)
+                      << sequential->ClassName() << ": " << result.mean << "+-" << result.stddev << std::endl;
+            auto writer = out << sequential->ClassName();
+            for (const std::string& param: columns) {
+                writer << params.Get<std::string>(param);
+            }
+            writer << result.mean << result.stddev;
+            speedups.SetSequential(params, result);
+        }
         for (auto& ptr: dsus) {
             DSU* dsu = ptr.get();
             Stats<double> result = benchmark.CollectThroughputStats(dsu);
             auto metrics = benchmark.CollectMetricStats(dsu);
             auto histMetrics = benchmark.CollectRawHistMetricStats(dsu);
+            auto timelines = benchmark.CollectTimelines(dsu);
+            auto samples = benchmark.CollectSamples(dsu);
+            std::string name = ResultName(dsu, params);
             std::cout << std::fixed << std::setprecision(3)
-                      << dsu->ClassName() << ": " << result.mean << "+-" << result.stddev << std::endl;
+                      << name << ": " << result.mean << "+-" << result.stddev << std::endl;
             std::vector<std::string> metricNames(metrics.size());
             std::transform(metrics.begin(), metrics.end(), metricNames.begin(), std::mem_fn(&decltype(metrics)::value_type::first));
             std::sort(metricNames.begin(), metricNames.end());
@@ -151,16 +294,19 @@ void RunBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& outH, const std::
             }
 
             { // write results in CSV
-                auto writer = out << dsu->ClassName();
-                for (const std::string& param: wlProvider->GetParameterNames()) {
+                auto writer = out << name;
+                for (const std::string& param: columns) {
                     writer << params.Get<std::string>(param);
                 }
                 writer << result.mean << result.stddev;
             }
+            auto makespanThroughput = metrics["makespan_throughput"];
+            speedups.Add(name, params, {(double) makespanThroughput.mean, (double) makespanThroughput.stddev},
+                         WorkerCores(ctx));
 
             for (const auto& [metric, value] : metrics) { // write metrics in CSV
-                auto writer = out << (dsu->ClassName() + ":" + metric);
-                for (const std::string& param : wlProvider->GetParameterNames()) {
+                auto writer = out << (name + ":" + metric);
+                for (const std::string& param : columns) {
                     writer << params.Get<std::string>(param);
                 }
                 writer << value.mean << value.stddev;
@@ -172,13 +318,126 @@ void RunBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& outH, const std::
             }
             size_t lastHistIndex = outH.GetNextIndex();
 
-            for (auto [index, name] : std::array{std::pair{firstHistIndex, "hist_begin"}, std::pair{lastHistIndex, "hist_end"}}) {
-                auto writer = out << (dsu->ClassName() + ":" + name);
-                for (const std::string& param : wlProvider->GetParameterNames()) {
+            for (auto [index, histName] : std::array{std::pair{firstHistIndex, "hist_begin"}, std::pair{lastHistIndex, "hist_end"}}) {
+                auto writer = out << (name + ":" + histName);
+                for (const std::string& param : columns) {
                     writer << params.Get<std::string>(param);
                 }
                 writer << index << 0;
             }
+
+            if (outTimelines) {
+                size_t firstTimelineIndex = outTimelines->GetNextIndex();
+                for (const auto& run : timelines) {
+                    *outTimelines << run;
+                }
+                size_t lastTimelineIndex = outTimelines->GetNextIndex();
+
+                for (auto [index, timelineName] : std::array{std::pair{firstTimelineIndex, "timeline_begin"},
+                                                             std::pair{lastTimelineIndex, "timeline_end"}}) {
+                    auto writer = out << (name + ":" + timelineName);
+                    for (const std::string& param : columns) {
+                        writer << params.Get<std::string>(param);
+                    }
+                    writer << index << 0;
+                }
+            }
+
+            if (outSeries) {
+                size_t firstSeriesIndex = outSeries->GetNextIndex();
+                for (const auto& run : samples) {
+                    *outSeries << run;
+                }
+                size_t lastSeriesIndex = outSeries->GetNextIndex();
+
+                for (auto [index, seriesName] : std::array{std::pair{firstSeriesIndex, "series_begin"},
+                                                           std::pair{lastSeriesIndex, "series_end"}}) {
+                    auto writer = out << (name + ":" + seriesName);
+                    for (const std::string& param : columns) {
+                        writer << params.Get<std::string>(param);
+                    }
+                    writer << index << 0;
+                }
+            }
+        }
+    }
+    speedups.Write(out);
+}
+
+/*
+ * Applies the workload as is (its unions build the sets) and measures bulk SameSet over the pairs of all
+ * its requests, whatever their type. With bulk_freeze the DSU is frozen first and answers with the kernel
+ * given by the "kernel" parameter; otherwise it answers live (e.g. by the wire batches of WireHelping).
+ */
+void RunBulkSameSetBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
+                             size_t numWorkloads, size_t numIterationsPerWorkload,
+                             WorkloadProvider* wlProvider, const std::vector<ParameterSet>& parameters) {
+    const std::vector<std::string> columns = ResultParameterNames(wlProvider);
+    { // write CSV header
+        auto writer = out << "DSU";
+        for (const std::string& param : columns) {
+            writer << param;
+        }
+        writer << "Score" << "Score Error";
+    }
+
+    Benchmark benchmark(ctx);
+    for (const auto& params : parameters) {
+        ApplyWorkers(ctx, params);
+        std::vector<std::unique_ptr<DSU>> dsus = GetAvailableDsus(ctx, params.Get<size_t>("N"), filter);
+        if (dsus.empty())
+            continue;
+        GatherKernel kernel = ParseGatherKernel(params.Get<std::string>("kernel"));
+        bool freeze = params.Get<bool>("bulk_freeze");
+
+        for (size_t i = 0; i < numWorkloads; ++i) {
+            std::cout << "Preparing workload #" << i << std::endl;
+            StaticWorkload workload = wlProvider->MakeWorkload(ctx, params);
+            for (auto& ptr: dsus) {
+                DSU* dsu = ptr.get();
+
+                PrepareDSUForWorkload(dsu, workload);
+                dsu->SetCompaction(ParseCompactionPolicy(params.Get<std::string>("compact")));
+                benchmark.Run(dsu, workload, true);
+                if (freeze)
+                    dsu->Freeze();
+
+                std::cout << "Warmup iteration for workload #" << i << "; DSU " << dsu->ClassName() << std::endl;
+                benchmark.RunBulkSameSet(dsu, workload, kernel, true);
+                for (size_t j = 0; j < numIterationsPerWorkload; ++j) {
+                    std::cout << "Benchmark iteration #" << j << " for workload #" << i << "; DSU " << dsu->ClassName()
+                              << std::endl;
+                    benchmark.RunBulkSameSet(dsu, workload, kernel);
+                }
+                dsu->Thaw();
+            }
+        }
+        for (auto& ptr: dsus) {
+            DSU* dsu = ptr.get();
+            std::string name = dsu->ClassName() + ":bulk_same_set/" + (freeze ? GatherKernelName(kernel) : "live");
+            Stats<double> result = benchmark.CollectThroughputStats(dsu);
+            auto metrics = benchmark.CollectMetricStats(dsu);
+            std::cout << std::fixed << std::setprecision(3)
+                      << name << ": " << result.mean << "+-" << result.stddev << std::endl;
+            if (metrics.contains("wire_round_trips_per_op")) {
+                auto value = metrics["wire_round_trips_per_op"];
+                std::cout << "  :wire_round_trips_per_op: " << value.mean << "+-" << value.stddev << std::endl;
+            }
+
+            {
+                auto writer = out << name;
+                for (const std::string& param: columns) {
+                    writer << params.Get<std::string>(param);
+                }
+                writer << result.mean << result.stddev;
+            }
+            for (const auto& [metric, value] : metrics) { // write metrics in CSV
+                auto writer = out << (name + ":" + metric);
+                for (const std::string& param : columns) {
+                    writer << params.Get<std::string>(param);
+                }
+                writer << value.mean << value.stddev;
+            }
         }
     }
 }
@@ -198,15 +457,16 @@ struct hash<std::pair<X, Y>> {
 void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, const std::regex& filter,
                   size_t numWorkloads, size_t numIterationsPerWorkload,
                   WorkloadProvider* wlProvider, const std::vector<std::vector<ParameterSet>>& parameterSets) {
+    const std::vector<std::string> columns = ResultParameterNames(wlProvider);
     { // write CSV header
         auto writer = out << "DSU" << "Parameter Set" << "Stage";
-        for (const std::string& param : wlProvider->GetParameterNames()) {
+        for (const std::string& param : columns) {
             writer << param;
         }
         writer << "Score" << "Score Error";
     }
 
-    Benchmark benchmark(ctx); // TODO pass additional work
+    Benchmark benchmark(ctx);
 
     size_t pSetCounter = 0;
     for (const std::vector<ParameterSet>& parameters : parameterSets) {
@@ -215,8 +475,20 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
         REQUIRE(std::all_of(parameters.begin(), parameters.end(), [n](const ParameterSet& params) {
             return params.Get<size_t>("N") == n;
         }), "All stage parameter sets must have equal N");
+        bool devirt = parameters[0].Get<bool>("devirt");
+        REQUIRE(std::all_of(parameters.begin(), parameters.end(), [devirt](const ParameterSet& params) {
+            return params.Get<bool>("devirt") == devirt;
+        }), "All stage parameter sets must have equal devirt");
+        REQUIRE(!parameters[0].Get<bool>("freeze"), "The first stage cannot be frozen: it starts from singletons");
+        for (const char* key : {"threads", "placement"}) {
+            std::string value = parameters[0].Get<std::string>(key);
+            REQUIRE(std::all_of(parameters.begin(), parameters.end(), [key, &value](const ParameterSet& params) {
+                return params.Get<std::string>(key) == value;
+            }), std::string("All stage parameter sets must have equal ") + key);
+        }
+        ApplyWorkers(ctx, parameters[0]);
 
-        std::vector<std::unique_ptr<DSU>> dsus = GetAvailableDsus(ctx, n, filter);
+        std::vector<std::unique_ptr<DSU>> dsus = GetAvailableDsus(ctx, n, filter, devirt);
         if (dsus.empty())
             continue;
 
@@ -239,13 +511,15 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                     PrepareDSUForWorkload(dsu, stages[0]);
 
                     for (size_t stageIndex = 0; stageIndex < stages.size(); ++stageIndex) {
-                        DSU::EnableCompaction = parameters[stageIndex].Get<bool>("compact");
+                        ApplyRunParameters(dsu, parameters[stageIndex]);
+                        ApplyBenchmarkParameters(benchmark, parameters[stageIndex]);
 
                         // warmup for the given parameter set
                         std::cout << "Warmup iteration for workload #" << i << "; DSU " << dsu->ClassName()
                                   << std::endl;
 
                         benchmark.Run(dsu, stages[stageIndex], true);
+                        FinishRun(dsu);
                     }
                 }
 
@@ -253,7 +527,8 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                     PrepareDSUForWorkload(dsu, stages[0]);
 
                     for (size_t stageIndex = 0; stageIndex < stages.size(); ++stageIndex) {
-                        DSU::EnableCompaction = parameters[stageIndex].Get<bool>("compact");
+                        ApplyRunParameters(dsu, parameters[stageIndex]);
+                        ApplyBenchmarkParameters(benchmark, parameters[stageIndex]);
 
                         std::cout << "Benchmark iteration #" << j << " for workload #" << i << ", stage #"
                                   << stageIndex
@@ -261,6 +536,7 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                                   << dsu->ClassName()
                                   << std::endl;
                         benchmark.Run(dsu, stages[stageIndex]);
+                        FinishRun(dsu);
                         std::pair<DSU*, size_t> key = {dsu, stageIndex};
                         auto throughput = benchmark.CollectRawThroughputStats(dsu);
                         auto metrics = benchmark.CollectRawMetricStats(dsu);
@@ -268,6 +544,7 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                         throughputRes[key].insert(throughputRes[key].end(), throughput.begin(), throughput.end());
                         metricRes[key].insert(metricRes[key].end(), metrics.begin(), metrics.end());
                         histRes[key].insert(histRes[key].end(), hists.begin(), hists.end());
+                        benchmark.CollectTimelines(dsu); // not reported for staged runs
                     }
                 }
             }
@@ -278,8 +555,9 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                 std::pair<DSU*, size_t> key = {dsu, stageIndex};
                 Stats<double> result = stats(throughputRes[key].begin(), throughputRes[key].end());
                 auto metrics = metricStats(metricRes[key].begin(), metricRes[key].end());
+                std::string name = ResultName(dsu, parameters[stageIndex]);
                 std::cout << std::fixed << std::setprecision(3)
-                          << dsu->ClassName() << "/" << stageIndex << ": " << result.mean << "+-" << result.stddev
+                          << name << "/" << stageIndex << ": " << result.mean << "+-" << result.stddev
                           << std::endl;
                 for (const auto& [metric, value]: metrics) {
                     std::cout << std::fixed << std::setprecision(3)
@@ -288,16 +566,16 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                 }
 
                 { // write results in CSV
-                    auto writer = out << dsu->ClassName() << setId << stageIndex;
-                    for (const std::string& param: wlProvider->GetParameterNames()) {
+                    auto writer = out << name << setId << stageIndex;
+                    for (const std::string& param: columns) {
                         writer << parameters[stageIndex].Get<std::string>(param);
                     }
                     writer << result.mean << result.stddev;
                 }
 
                 for (const auto& [metric, value]: metrics) { // write metrics in CSV
-                    auto writer = out << (dsu->ClassName() + ":" + metric) << setId << stageIndex;
-                    for (const std::string& param: wlProvider->GetParameterNames()) {
+                    auto writer = out << (name + ":" + metric) << setId << stageIndex;
+                    for (const std::string& param: columns) {
                         writer << parameters[stageIndex].Get<std::string>(param);
                     }
                     writer << value.mean << value.stddev;
@@ -310,9 +588,9 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
                 }
                 size_t lastHistIndex = histOut.GetNextIndex();
 
-                for (auto [index, name] : std::array{std::pair{firstHistIndex, "hist_begin"}, std::pair{lastHistIndex, "hist_end"}}) {
-                    auto writer = out << (dsu->ClassName() + ":" + name) << setId << stageIndex;
-                    for (const std::string& param : wlProvider->GetParameterNames()) {
+                for (auto [index, histName] : std::array{std::pair{firstHistIndex, "hist_begin"}, std::pair{lastHistIndex, "hist_end"}}) {
+                    auto writer = out << (name + ":" + histName) << setId << stageIndex;
+                    for (const std::string& param : columns) {
                         writer << parameters[stageIndex].Get<std::string>(param);
                     }
                     writer << index << 0;
@@ -326,6 +604,7 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, HistCsvFile& histOut, co
 int main(int argc, const char* argv[]) {
     std::vector<std::shared_ptr<WorkloadProvider>> wlProviders = {
             std::make_shared<ComponentsRandomWorkloadV2>(),
+            std::make_shared<SkewedMergeWorkload>(),
 //            std::make_shared<ExternalGraphWorkload>()
     };
 
@@ -358,6 +637,22 @@ int main(int argc, const char* argv[]) {
     std::vector<std::string> rawStageParameters;
     app.add_option("--sp,--stage-param", rawStageParameters, "For staged benchmark: stage parameter in the form stageId:param=value");
 
+    size_t oversubscription = 1;
+    app.add_option("--oversubscribe", oversubscription, "Number of worker threads per CPU (threads > cores mode)");
+
+    bool noSequential = false;
+    app.add_flag("--no-sequential", noSequential, "Do not run the sequential baseline (and report no speedups over it)");
+
+    bool writeTimelines = false;
+    app.add_flag("--timeline", writeTimelines, "Write per-thread progress of every measured run to timeline-<out>");
+
+    size_t samplingMs = 0;
+    app.add_option("--sample-ms", samplingMs,
+                   "Sample metrics (with -m) every this many ms during measured runs and write them to series-<out>");
+
+    bool bulkSameSet = false;
+    app.add_flag("--bulk-same-set", bulkSameSet, "Benchmark bulk SameSet queries (see the kernel and bulk_freeze parameters)");
+
     CLI11_PARSE(app, argc, argv);
 
     auto wlProviderIt = std::find_if(wlProviders.begin(), wlProviders.end(), [&workloadName](const auto& provider) {
@@ -366,9 +661,30 @@ int main(int argc, const char* argv[]) {
     REQUIRE(wlProviderIt != wlProviders.end(), "Invalid workload");
     WorkloadProvider* wlProvider = wlProviderIt->get();
 
+    NUMAContext ctx(4);
+    if (testing) {
+        ctx.SetupForTests(8, 4);
+    }
+    ctx.SetOversubscription(oversubscription);
+
     ParameterSet commonDefaults = ParseParameters({
         "N=4000000",
-        "compact=true"
+        "threads=" + std::to_string(ctx.MaxConcurrency()), // worker threads; list it for a scalability curve
+        "placement=compact", // CPUs of the workers: compact (fill a node first) or spread (round-robin over nodes)
+        "duration_ms=0", // if positive, workers cycle through their requests for this long (fixed-duration run)
+        "rate=0", // if positive, requests of a worker arrive as a Poisson process of this rate per second (open loop; needs duration_ms)
+        "work=2", // mean random work after every request of the closed loop
+        "sample_latency=false", // time every 64th request of the closed loop (splits the devirtualized loop)
+        "compact=true", // path compaction: true (full), halving, false (none) or adaptive
+        "bulk_preheat=false", // build the preheat sets by BulkBuild instead of applying the preheat requests
+        "freeze=false", // answer SameSet from frozen labels; the run (stage) must not merge sets
+        "kernel=auto", // bulk SameSet kernel: auto, scalar, avx2 or avx512
+        "bulk_freeze=true", // bulk SameSet over a frozen DSU (by the kernel); false measures the live path
+        "wait=spin", // how threads wait for each other: spin, backoff, yield or park
+        "routing=false", // dispatch requests to the nodes owning their vertices
+        "daemon=false", // background compaction of the replicas (Adaptive family)
+        "devirt=false", // apply requests by a loop compiled for each DSU type (Devirtualized)
+        "layout=aos" // request stream of a worker: aos (packed Request array) or soa (RequestColumns)
     })[0];
     ParameterSet defaultParams = wlProvider->GetDefaultParameters(&commonDefaults);
 
@@ -383,18 +699,22 @@ int main(int argc, const char* argv[]) {
 
     DSU::EnableMetrics = enableMetrics;
 
-    NUMAContext ctx(4);
-    if (testing) {
-        ctx.SetupForTests(8, 4);
-    }
-
     CsvFile out(outFileName);
     HistCsvFile outHists(CsvFile("hists-" + outFileName));
 
-    if (!stageParameters.empty()) {
+    if (bulkSameSet) {
+        RunBulkSameSetBenchmark(&ctx, out, filter, numWorkloads, numIterationsPerWorkload, wlProvider, parameters);
+    } else if (!stageParameters.empty()) {
         RunStagedBenchmark(&ctx, out, outHists, filter, numWorkloads, numIterationsPerWorkload, wlProvider, stageParameters);
     } else {
-        RunBenchmark(&ctx, out, outHists, filter, numWorkloads, numIterationsPerWorkload, wlProvider, parameters);
+        std::unique_ptr<TimelineCsvFile> outTimelines;
+        if (writeTimelines)
+            outTimelines = std::make_unique<TimelineCsvFile>(CsvFile("timeline-" + outFileName));
+        std::unique_ptr<SeriesCsvFile> outSeries;
+        if (samplingMs > 0)
+            outSeries = std::make_unique<SeriesCsvFile>(CsvFile("series-" + outFileName));
+        RunBenchmark(&ctx, out, outHists, outTimelines.get(), outSeries.get(), std::chrono::milliseconds(samplingMs),
+                     filter, numWorkloads, numIterationsPerWorkload, wlProvider, parameters, !noSequential);
     }
     return 0;
 }
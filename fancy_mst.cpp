@@ -0,0 +1,157 @@
+#include "lib/stats.hpp"
+#include "lib/timer.hpp"
+#include "lib/graphs.h"
+#include "lib/csv.hpp"
+#include "lib/parameters.hpp"
+#include "lib/dsu_registry.hpp"
+
+#include "mst/boruvka.hpp"
+#include "mst/filter_kruskal.hpp"
+
+#include <CLI/App.hpp>
+#include <CLI/Formatter.hpp>
+#include <CLI/Config.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <regex>
+#include <algorithm>
+#include <optional>
+
+
+const std::vector<std::string> PARAMETER_NAMES = {"N", "E", "graph", "engine", "compact"};
+
+Graph MakeGraph(NUMAContext* ctx, const ParameterSet& params) {
+    int n = params.Get<int>("N");
+    int e = params.Get<int>("E");
+    auto graph = params.Get<std::string>("graph");
+    if (graph == "random")
+        return graphRandom(n, e);
+    if (graph == "components") {
+        int parts = (int) ctx->NodeCount();
+        return generateComponentsShuffled(parts, n / parts, e / parts);
+    }
+    return graphFromFile(graph);
+}
+
+/*
+ * Score is the time of building the minimum spanning forest, in milliseconds.
+ */
+void RunMstBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
+                     size_t numGraphs, size_t numIterationsPerGraph,
+                     const std::vector<std::shared_ptr<MstEngine>>& engines,
+                     const std::vector<ParameterSet>& parameters) {
+    { // write CSV header
+        auto writer = out << "DSU";
+        for (const std::string& param : PARAMETER_NAMES) {
+            writer << param;
+        }
+        writer << "Score" << "Score Error";
+    }
+
+    for (const auto& params : parameters) {
+        auto engineIt = std::find_if(engines.begin(), engines.end(), [&params](const auto& engine) {
+            return engine->Name() == params.Get<std::string>("engine");
+        });
+        REQUIRE(engineIt != engines.end(), "Invalid MST engine");
+        MstEngine* engine = engineIt->get();
+
+        std::vector<std::unique_ptr<DSU>> dsus;
+        std::vector<std::vector<double>> times;
+        for (size_t i = 0; i < numGraphs; ++i) {
+            std::cout << "Preparing graph #" << i << std::endl;
+            Graph graph = MakeGraph(ctx, params);
+            if (dsus.empty()) {
+                dsus = GetAvailableDsus(ctx, graph.N, filter);
+                // SeveralDSU keeps independent per-node DSUs and cannot hold a spanning forest
+                std::erase_if(dsus, [](const std::unique_ptr<DSU>& dsu) {
+                    return dsu->ClassName() == "SeveralDSU";
+                });
+                times.resize(dsus.size());
+            }
+
+            std::optional<long long> expectedWeight;
+            for (size_t d = 0; d < dsus.size(); ++d) {
+                DSU* dsu = dsus[d].get();
+                for (size_t j = 0; j <= numIterationsPerGraph; ++j) {
+                    dsu->Thaw();
+                    dsu->ReInit();
+                    dsu->SetCompaction(ParseCompactionPolicy(params.Get<std::string>("compact")));
+                    std::cout << (j == 0 ? "Warmup iteration" : "Benchmark iteration #" + std::to_string(j - 1))
+                              << " for graph #" << i << "; DSU " << dsu->ClassName() << std::endl;
+                    Timer timer;
+                    long long weight = engine->Run(ctx, dsu, graph.N, graph.Edges);
+                    auto duration = timer.Get<std::chrono::microseconds>();
+
+                    if (!expectedWeight)
+                        expectedWeight = weight;
+                    REQUIRE(weight == *expectedWeight, "MST weight mismatch for " + dsu->ClassName());
+                    if (j > 0)
+                        times[d].push_back(duration.count() / 1000.0);
+                }
+            }
+        }
+
+        for (size_t d = 0; d < dsus.size(); ++d) {
+            DSU* dsu = dsus[d].get();
+            Stats<double> result = stats(times[d].begin(), times[d].end());
+            std::cout << std::fixed << std::setprecision(3)
+                      << dsu->ClassName() << ": " << result.mean << "+-" << result.stddev << " ms" << std::endl;
+
+            auto writer = out << dsu->ClassName();
+            for (const std::string& param : PARAMETER_NAMES) {
+                writer << params.Get<std::string>(param);
+            }
+            writer << result.mean << result.stddev;
+        }
+    }
+}
+
+
+int main(int argc, const char* argv[]) {
+    std::vector<std::shared_ptr<MstEngine>> engines = {
+            std::make_shared<BoruvkaMst>(),
+            std::make_shared<FilterKruskalMst>()
+    };
+
+    CLI::App app("NUMA DSU MST Benchmark");
+
+    std::vector<std::string> rawParameters;
+    app.add_option("-p,--param", rawParameters, "Parameter in the form key=val1,val2,...,valN");
+
+    bool testing = false;
+    app.add_flag("--testing", testing, "Setup NUMA context for testing with 8 CPUs on 4 nodes");
+
+    std::string dsuFilter = ".*";
+    app.add_option("-d,--dsu", dsuFilter, "ECMAScript regular expression specifying DSUs to benchmark");
+
+    std::string outFileName = "mst.csv";
+    app.add_option("-o,--out", outFileName, "Output CSV file");
+
+    size_t numGraphs = 1;
+    app.add_option("-n,--num-graphs", numGraphs, "Number of graphs participating in each experiment");
+
+    size_t numIterationsPerGraph = 3;
+    app.add_option("-i,--num-iterations", numIterationsPerGraph, "Number of iterations per graph");
+
+    CLI11_PARSE(app, argc, argv);
+
+    ParameterSet defaults = ParseParameters({
+        "N=4000000",
+        "E=32000000",
+        "graph=random", // random, components or a path to a graph file
+        "engine=boruvka", // boruvka or filter-kruskal
+        "compact=true" // path compaction: true (full), halving, false (none) or adaptive
+    })[0];
+    auto parameters = ParseParameters(rawParameters, &defaults);
+    auto filter = std::regex(dsuFilter, std::regex::ECMAScript | std::regex::icase | std::regex::nosubs);
+
+    NUMAContext ctx(4);
+    if (testing) {
+        ctx.SetupForTests(8, 4);
+    }
+
+    CsvFile out(outFileName);
+    RunMstBenchmark(&ctx, out, filter, numGraphs, numIterationsPerGraph, engines, parameters);
+    return 0;
+}
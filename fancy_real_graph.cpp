@@ -5,17 +5,9 @@
 #include "lib/parameters.hpp"
 #include "lib/benchmark.hpp"
 #include "lib/workload_provider.hpp"
+#include "lib/dsu_registry.hpp"
 
 #include "DSU.h"
-#include "implementations/DSU_ParallelUnions.h"
-#include "implementations/DSU_ParallelUnions_no_imm.h"
-#include "implementations/DSU_Usual.h"
-#include "implementations/DSU_Usual_noimm.h"
-#include "implementations/DSU_Adaptive.h"
-#include "implementations/DSU_AdaptiveSmart.h"
-#include "implementations/DSU_AdaptiveLocks.h"
-#include "implementations/DSU_LazyUnion.h"
-#include "implementations/SeveralDSU.h"
 
 #include "workloads/components_v2.hpp"
 
@@ -29,62 +21,6 @@
 #include <regex>
 
 
-std::vector<std::unique_ptr<DSU>> GetAvailableDsus(NUMAContext* ctx, size_t N, const std::regex& filter) {
-    std::vector<std::unique_ptr<DSU>> dsus;
-
-    dsus.emplace_back(new DSU_Usual(N));
-    dsus.emplace_back(new SeveralDSU(ctx, N));
-
-    auto construct = [&]<class T> (T) {
-        dsus.emplace_back(new DSU_ParallelUnions<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_Adaptive<T::value, false>(ctx, N));
-        dsus.emplace_back(new DSU_Adaptive<T::value, true>(ctx, N));
-        dsus.emplace_back(new DSU_AdaptiveLocks<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_AdaptiveSmart<T::value>(ctx, N));
-        dsus.emplace_back(new DSU_LazyUnions<T::value>(ctx, N));
-    };
-
-    construct(std::true_type{});
-    construct(std::false_type{});
-
-
-    //dsus.emplace_back(new DSU_Usual_NoImm(N));
-
-    //dsus.emplace_back(new TwoDSU(N, node_count));
-    //dsus.emplace_back(new DSU_ParallelUnions_NoImm(N, node_count));
-
-//    dsus.emplace_back(new DSU_NO_SYNC(N, node_count));
-    //dsus.emplace_back(new DSU_NO_SYNC_NoImm(N, node_count));
-
-//    dsus.emplace_back(new DSU_Parts(N, node_count, owners));
-    //dsus.emplace_back(new DSU_Parts_NoImm(N, node_count, owners));
-
-//    dsus.emplace_back(new DSU_NoSync_Parts(N, node_count, owners));
-    //dsus.emplace_back(new DSU_NoSync_Parts_NoImm(N, node_count, owners));
-
-
-    auto end = std::remove_if(dsus.begin(), dsus.end(), [&filter](const std::unique_ptr<DSU>& dsu) {
-        return !std::regex_match(dsu->ClassName(), filter);
-    });
-    dsus.resize(end - dsus.begin());
-    return dsus;
-}
-
-void PrepareDSUForWorkload(NUMAContext* ctx, DSU* dsu, const StaticWorkload& workload) {
-    dsu->ReInit();
-
-    // FIXME This is a hack to test the conjecture.
-    PrepareDSUForWorkload<DSU_Adaptive<false, false>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<true, false>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<false, true>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_Adaptive<true, true>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveLocks<false>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveLocks<true>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveSmart<false>>(ctx, dsu, workload);
-    PrepareDSUForWorkload<DSU_AdaptiveSmart<true>>(ctx, dsu, workload);
-}
-
-
 void RunBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
                   size_t numWorkloads, size_t numIterationsPerWorkload,
                   WorkloadProvider* wlProvider, const std::vector<ParameterSet>& parameters) {
@@ -109,8 +45,8 @@ void RunBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
                 DSU* dsu = ptr.get();
 
                 if (i == 0) {
-                    PrepareDSUForWorkload(ctx, dsu, workload);
-                    DSU::EnableCompaction = params.Get<bool>("compact");
+                    PrepareDSUForWorkload(dsu, workload);
+                    dsu->SetCompaction(ParseCompactionPolicy(params.Get<std::string>("compact")));
 
                     // warmup for the given parameter set
                     std::cout << "Warmup iteration for workload #" << i << "; DSU " << dsu->ClassName() << std::endl;
@@ -118,8 +54,8 @@ void RunBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
                 }
 
                 for (size_t j = 0; j < numIterationsPerWorkload; ++j) {
-                    PrepareDSUForWorkload(ctx, dsu, workload);
-                    DSU::EnableCompaction = params.Get<bool>("compact");
+                    PrepareDSUForWorkload(dsu, workload);
+                    dsu->SetCompaction(ParseCompactionPolicy(params.Get<std::string>("compact")));
 
                     std::cout << "Benchmark iteration #" << j << " for workload #" << i << "; DSU " << dsu->ClassName()
                               << std::endl;
@@ -206,10 +142,10 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter
                     DSU* dsu = ptr.get();
 
                     if (i == 0) {
-                        PrepareDSUForWorkload(ctx, dsu, stages[0]);
+                        PrepareDSUForWorkload(dsu, stages[0]);
 
                         for (size_t stageIndex = 0; stageIndex < stages.size(); ++stageIndex) {
-                            DSU::EnableCompaction = parameters[stageIndex].Get<bool>("compact");
+                            dsu->SetCompaction(ParseCompactionPolicy(parameters[stageIndex].Get<std::string>("compact")));
 
                             // warmup for the given parameter set
                             std::cout << "Warmup iteration for workload #" << i << "; DSU " << dsu->ClassName()
@@ -220,10 +156,10 @@ void RunStagedBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter
                     }
 
                     for (size_t j = 0; j < numIterationsPerWorkload; ++j) {
-                        PrepareDSUForWorkload(ctx, dsu, stages[0]);
+                        PrepareDSUForWorkload(dsu, stages[0]);
 
                         for (size_t stageIndex = 0; stageIndex < stages.size(); ++stageIndex) {
-                            DSU::EnableCompaction = parameters[stageIndex].Get<bool>("compact");
+                            dsu->SetCompaction(ParseCompactionPolicy(parameters[stageIndex].Get<std::string>("compact")));
 
                             std::cout << "Benchmark iteration #" << j << " for workload #" << i << ", stage #"
                                       << stageIndex
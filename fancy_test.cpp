@@ -4,13 +4,53 @@
 #include "implementations/DSU_Adaptive.h"
 #include "implementations/DSU_AdaptiveSmart.h"
 #include "implementations/DSU_AdaptiveLocks.h"
+#include "implementations/DSU_FC.h"
 #include "implementations/DSU_LazyUnion.h"
 #include "implementations/DSU_ParallelUnions.h"
+#include "implementations/DSU_WireHelping.h"
 
 #include "lib/numa.hpp"
+#include "lib/benchmark.hpp"
+#include "lib/dsu_registry.hpp"
+#include "lib/pair_queue.hpp"
+#include "workloads/components_v2.hpp"
+#include "utils/ConcurrencyFreaks/queues/array/FAAArrayQueue.hpp"
+#include "mst/boruvka.hpp"
+#include "mst/filter_kruskal.hpp"
 
 #include <barrier>
+#include <climits>
 #include <memory>
+#include <numeric>
+#include <set>
+
+
+/*
+ * Vertices with equal u % K form a set: thread u % threads unites u and u + K, and with `sameSetQueries`
+ * thread (u + 1) % threads also asks whether u and u + 1 are in one set. The first `preheat` unions
+ * are preheat requests instead. All vertices are owned by node 0.
+ */
+StaticWorkload MakeModuloWorkload(int N, int K, int threads, bool sameSetQueries = true, int preheat = 0) {
+    StaticWorkload workload;
+    workload.N = N;
+    workload.Metadata.emplace_back(ComponentMappingMd{std::vector<int>(N, 0)});
+    workload.ThreadRequests.resize(threads);
+    for (int u = 0; u + K < N; ++u) {
+        auto& requests = u < preheat ? workload.PreHeatRequests : workload.ThreadRequests[u % threads];
+        requests.push_back({false, u, u + K});
+        if (sameSetQueries)
+            workload.ThreadRequests[(u + 1) % threads].push_back({true, u, u + 1});
+    }
+    return workload;
+}
+
+// the sets of MakeModuloWorkload, or of any unions of u and u + K
+void ExpectModuloSets(DSU& dsu, int K) {
+    for (int u = 0; u + K < dsu.Size(); ++u) {
+        EXPECT_TRUE(dsu.SameSet(u, u + K)) << u;
+        EXPECT_FALSE(dsu.SameSet(u, u + 1)) << u;
+    }
+}
 
 
 template <class DSU>
@@ -23,9 +63,13 @@ public:
     }
 };
 
-using Dsus = ::testing::Types<DSU_Adaptive<true, false>, DSU_Adaptive<true, true>, DSU_AdaptiveLocks<true>, DSU_LazyUnions<true>, DSU_ParallelUnions<true>,
+using Dsus = ::testing::Types<DSU_Adaptive<true, false>, DSU_Adaptive<true, true>, DSU_AdaptiveLocks<true>, DSU_AdaptiveLocks<true, true>, DSU_LazyUnions<true>, DSU_ParallelUnions<true>,
         DSU_Adaptive<false, false>, DSU_Adaptive<false, true>, DSU_AdaptiveLocks<false>, DSU_LazyUnions<false>, DSU_ParallelUnions<false>,
-        DSU_AdaptiveSmart<false>, DSU_AdaptiveSmart<true>>;
+        DSU_AdaptiveSmart<false>, DSU_AdaptiveSmart<true>, DSU_WireHelping<false, false>, DSU_WireHelping<true, false>,
+        DSU_WireHelping<true, false, false, true>, DSU_WireHelping<false, true>, DSU_WireHelping<true, true>, DSU_FC<false>, DSU_FC<true>,
+        DSU_Adaptive<true, false, true, ReplicationPolicy::Never>, DSU_Adaptive<false, false, true, ReplicationPolicy::AfterK>,
+        DSU_Adaptive<true, true, true, ReplicationPolicy::AfterK>,
+        DSU_Adaptive<false, true, false>, DSU_AdaptiveSmart<true, true>, DSU_WireHelping<true, true, true>>;
 TYPED_TEST_SUITE(DSUTest, Dsus);
 
 TYPED_TEST(DSUTest, Simple) {
@@ -69,3 +113,861 @@ TYPED_TEST(DSUTest, SimpleConcurrent) {
     }, 4);
     this->Ctx_.Join();
 }
+
+TYPED_TEST(DSUTest, Freeze) {
+    this->Ctx_.SetupForTests(4, 2);
+    auto dsu = this->MakeDSU(6);
+    this->Ctx_.StartNThreads([&]{
+        dsu->Union(0, 1);
+        dsu->Union(1, 2);
+        dsu->Union(5, 3);
+    }, 4);
+    this->Ctx_.Join();
+
+    dsu->Freeze(true);
+    ASSERT_TRUE(dsu->IsFrozen());
+    EXPECT_EQ(dsu->Frozen()->ComponentCount(), 3);
+    this->Ctx_.StartNThreads([&]{
+        int node = NUMAContext::CurrentThreadNode();
+        EXPECT_TRUE(dsu->SameSet(0, 2));
+        EXPECT_TRUE(dsu->SameSet(3, 5));
+        EXPECT_FALSE(dsu->SameSet(0, 3));
+        EXPECT_FALSE(dsu->SameSet(4, 5));
+        std::set<int> labels;
+        for (int u : {0, 3, 4}) {
+            int label = dsu->Frozen()->Label(u, node);
+            EXPECT_TRUE(0 <= label && label < 3);
+            labels.insert(label);
+        }
+        EXPECT_EQ(labels.size(), 3u);
+        dsu->Union(1, 0); // same set, allowed
+    }, 4);
+    this->Ctx_.Join();
+
+    dsu->Thaw();
+    this->Ctx_.StartNThreads([&]{
+        dsu->Union(4, 5);
+        EXPECT_TRUE(dsu->SameSet(3, 4));
+        EXPECT_FALSE(dsu->SameSet(0, 4));
+    }, 4);
+    this->Ctx_.Join();
+}
+
+TYPED_TEST(DSUTest, BulkSameSet) {
+    this->Ctx_.SetupForTests(4, 2);
+    constexpr int N = 300;
+    auto dsu = this->MakeDSU(N);
+    std::vector<VertexPair> queries;
+    for (int i = 0; i < 203; ++i) {
+        queries.push_back({(i * 37) % N, (i * 91 + 5) % N});
+    }
+    this->Ctx_.StartNThreads([&]{
+        for (int u = NUMAContext::CurrentThreadId(); u + 7 < N; u += 4) {
+            dsu->Union(u, u + 7);
+        }
+    }, 4);
+    this->Ctx_.Join();
+
+    auto check = [&](GatherKernel kernel) {
+        std::vector<uint64_t> result((queries.size() + 63) / 64);
+        dsu->BulkSameSet(queries, result.data(), kernel);
+        for (size_t i = 0; i < queries.size(); ++i) {
+            bool bit = (result[i / 64] >> (i % 64)) & 1;
+            EXPECT_EQ(bit, (queries[i].u - queries[i].v) % 7 == 0) << GatherKernelName(kernel) << " query #" << i;
+        }
+    };
+
+    this->Ctx_.StartNThreads([&]{
+        check(GatherKernel::Auto);
+    }, 4);
+    this->Ctx_.Join();
+
+    dsu->Freeze();
+    this->Ctx_.StartNThreads([&]{
+        for (auto kernel : {GatherKernel::Scalar, GatherKernel::AVX2, GatherKernel::AVX512}) {
+            if (IsGatherKernelSupported(kernel))
+                check(kernel);
+        }
+    }, 4);
+    this->Ctx_.Join();
+}
+
+TYPED_TEST(DSUTest, BulkBuild) {
+    this->Ctx_.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    auto dsu = this->MakeDSU(N);
+    std::vector<VertexPair> edges;
+    for (int u = N - 1; u >= 10; --u) {
+        edges.push_back({u, u - 10});
+        edges.push_back({u, u});
+    }
+    this->Ctx_.StartNThreads([&]{
+        dsu->Union(0, 1);
+    }, 1);
+    this->Ctx_.Join();
+
+    dsu->BulkBuild(edges);
+    this->Ctx_.StartNThreads([&]{
+        EXPECT_TRUE(dsu->SameSet(990, 0));
+        EXPECT_TRUE(dsu->SameSet(991, 0));
+        EXPECT_TRUE(dsu->SameSet(992, 12));
+        EXPECT_FALSE(dsu->SameSet(992, 3));
+        EXPECT_FALSE(dsu->SameSet(999, 0));
+        EXPECT_EQ(static_cast<DSU*>(dsu.get())->Find(995), 5);
+    }, 4);
+    this->Ctx_.Join();
+
+    this->Ctx_.StartNThreads([&]{
+        dsu->Union(2, 3);
+        EXPECT_TRUE(dsu->SameSet(992, 3));
+        EXPECT_FALSE(dsu->SameSet(992, 4));
+    }, 4);
+    this->Ctx_.Join();
+}
+
+TYPED_TEST(DSUTest, TryUnion) {
+    this->Ctx_.SetupForTests(4, 2);
+    auto dsu = this->MakeDSU(6);
+    this->Ctx_.StartNThreads([&]{
+        UnionResult r = dsu->TryUnion(3, 1);
+        EXPECT_TRUE(r.merged);
+        EXPECT_EQ(r.root, 1);
+        r = dsu->TryUnion(5, 3);
+        EXPECT_TRUE(r.merged);
+        EXPECT_EQ(r.root, 1);
+        r = dsu->TryUnion(1, 5);
+        EXPECT_FALSE(r.merged);
+        EXPECT_EQ(r.root, 1);
+        DSU* base = dsu.get();
+        EXPECT_EQ(base->FindPair(5, 3), std::make_pair(1, 1));
+        EXPECT_EQ(base->FindPair(4, 5), std::make_pair(4, 1));
+        EXPECT_EQ(base->FindPair(1, 4), std::make_pair(1, 4));
+    }, 1);
+    this->Ctx_.Join();
+
+    std::atomic<int> merges = 0;
+    this->Ctx_.StartNThreads([&]{
+        if (dsu->TryUnion(0, 2).merged)
+            ++merges;
+        EXPECT_TRUE(dsu->SameSet(0, 2));
+        EXPECT_FALSE(dsu->SameSet(0, 1));
+    }, 4);
+    this->Ctx_.Join();
+    EXPECT_GE(merges.load(), 1);
+}
+
+TYPED_TEST(DSUTest, WaitPolicies) {
+    this->Ctx_.SetupForTests(2, 2);
+    this->Ctx_.SetOversubscription(2);
+    constexpr int N = 64;
+    for (auto policy : {WaitPolicy::Spin, WaitPolicy::Backoff, WaitPolicy::Yield, WaitPolicy::Park}) {
+        auto dsu = this->MakeDSU(N);
+        dsu->SetWaitPolicy(policy);
+        std::barrier barrier(4);
+        this->Ctx_.StartNThreads([&]{
+            for (int i = NUMAContext::CurrentThreadId(); i + 1 < N; i += 4) {
+                dsu->Union(i + 1, i);
+                dsu->Union(0, N - 1 - i);
+            }
+            barrier.arrive_and_wait();
+            for (int i = 0; i < N; ++i) {
+                EXPECT_TRUE(dsu->SameSet(i, 0)) << WaitPolicyName(policy);
+            }
+        }, 4);
+        this->Ctx_.Join();
+    }
+}
+
+TYPED_TEST(DSUTest, CompactionPolicies) {
+    this->Ctx_.SetupForTests(4, 2);
+    constexpr int N = 512;
+    for (auto policy : {CompactionPolicy::Full, CompactionPolicy::Halving, CompactionPolicy::None, CompactionPolicy::Adaptive}) {
+        auto dsu = this->MakeDSU(N);
+        dsu->SetCompaction(policy);
+        std::barrier barrier(4);
+        // two sets: even and odd vertices
+        this->Ctx_.StartNThreads([&]{
+            for (int i = NUMAContext::CurrentThreadId(); i + 2 < N; i += 4) {
+                dsu->Union(N - 1 - i, N - 3 - i);
+            }
+            barrier.arrive_and_wait();
+            for (int i = 0; i < N; ++i) {
+                EXPECT_TRUE(dsu->SameSet(i, i % 2)) << CompactionPolicyName(policy);
+                EXPECT_FALSE(dsu->SameSet(i, 1 - i % 2)) << CompactionPolicyName(policy);
+            }
+        }, 4);
+        this->Ctx_.Join();
+    }
+}
+
+TYPED_TEST(DSUTest, Mst) {
+    this->Ctx_.SetupForTests(4, 2);
+    constexpr int N = 2000;
+    Graph graph = graphRandom(N, 3 * N);
+
+    std::vector<int> order(graph.Edges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int i, int j) {
+        return std::pair{graph.Edges[i].w, i} < std::pair{graph.Edges[j].w, j};
+    });
+    std::vector<int> parent(N);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int u) {
+        while (parent[u] != u)
+            u = parent[u] = parent[parent[u]];
+        return u;
+    };
+    long long expected = 0;
+    for (int i : order) {
+        int u = find(graph.Edges[i].u), v = find(graph.Edges[i].v);
+        if (u != v) {
+            parent[u] = v;
+            expected += graph.Edges[i].w;
+        }
+    }
+
+    auto dsu = this->MakeDSU(N);
+    BoruvkaMst boruvka;
+    FilterKruskalMst filterKruskal;
+    for (MstEngine* engine : std::initializer_list<MstEngine*>{&boruvka, &filterKruskal}) {
+        dsu->ReInit();
+        EXPECT_EQ(engine->Run(&this->Ctx_, dsu.get(), N, graph.Edges), expected) << engine->Name();
+    }
+}
+
+TEST(WireHelpingTest, ChannelsReopenAfterReInit) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    DSU::EnableMetrics = true;
+    DSU_WireHelping<true, false> dsu(&ctx, 8);
+    DSU::EnableMetrics = false;
+
+    for (int round = 0; round < 2; ++round) {
+        dsu.ReInit();
+        dsu.resetMetrics();
+        std::barrier barrier(4);
+        ctx.StartNThreads([&]{
+            if (NUMAContext::CurrentThreadNode() == 0) {
+                dsu.Union(0, 1);
+                dsu.Union(2, 3);
+            }
+            barrier.arrive_and_wait();
+            // vertices are owned by node 0, so node 1 delegates its finds
+            EXPECT_TRUE(dsu.SameSet(1, 0));
+            EXPECT_FALSE(dsu.SameSet(1, 3));
+            std::vector<VertexPair> queries = {{1, 0}, {3, 2}, {0, 3}, {4, 5}};
+            uint64_t result = 0;
+            dsu.BulkSameSet(queries, &result);
+            EXPECT_EQ(result, 0b0011u);
+            dsu.GoAway();
+        }, 4);
+        ctx.Join();
+
+        Metrics metrics = dsu.collectMetrics();
+        EXPECT_GT(metrics["wire_round_trips"], 0) << "round " << round;
+        EXPECT_GE(metrics["wire_requests"], metrics["wire_round_trips"]);
+    }
+}
+
+TEST(WireHelpingTest, ThreadsJoinAndLeave) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    DSU_WireHelping<true, false> dsu(&ctx, 8);
+    for (int v = 4; v < 8; ++v) {
+        dsu.SetOwner(v, 1);
+    }
+    dsu.Union(4, 5);
+    dsu.Union(6, 0);
+
+    // thread 3 never runs; thread 2 is the only server of node 1 and leaves and rejoins repeatedly
+    ctx.StartNThreads([&]{
+        for (int i = 0; i < 2000; ++i) {
+            EXPECT_TRUE(dsu.SameSet(5, 4));
+            EXPECT_TRUE(dsu.SameSet(0, 6));
+            EXPECT_FALSE(dsu.SameSet(7, 4));
+            if (NUMAContext::CurrentThreadId() == 2 && i % 100 == 0)
+                dsu.GoAway();
+        }
+        dsu.GoAway();
+    }, 3);
+    ctx.Join();
+}
+
+TEST(WireHelpingTest, BulkBuildLeavesNoServers) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    ctx.SetWorkers(2, ThreadPlacement::Compact); // node 1 has no workers
+    DSU::EnableMetrics = true;
+    DSU_WireHelping<true, false> dsu(&ctx, 8);
+    for (int v = 4; v < 8; ++v) {
+        dsu.SetOwner(v, 1);
+    }
+    std::vector<VertexPair> edges = {{4, 5}, {6, 0}, {1, 2}};
+    dsu.BulkBuild(edges);
+    dsu.resetMetrics();
+
+    // no thread of node 1 is left registered as its server, so its vertices are read directly
+    ctx.StartNThreads([&]{
+        EXPECT_TRUE(dsu.SameSet(5, 4));
+        EXPECT_TRUE(dsu.SameSet(0, 6));
+        EXPECT_FALSE(dsu.SameSet(7, 4));
+        dsu.GoAway();
+    }, 2);
+    ctx.Join();
+    EXPECT_EQ(dsu.collectMetrics()["wire_round_trips"], 0);
+    DSU::EnableMetrics = false;
+}
+
+TEST(WireHelpingTest, LiveBulkSameSetBatchesRoundTrips) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 20000;
+    DSU::EnableMetrics = true;
+    // dedicated servers keep the channels open however the workers are scheduled
+    DSU_WireHelping<true, false, false, true> dsu(&ctx, N);
+    // the queries u, u + 3 of singletons owned by both nodes: every query asks the other node about a root
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, false);
+    std::vector<int> owners(N);
+    for (int u = 0; u < N; ++u) {
+        owners[u] = u % 2;
+    }
+    workload.Metadata = {ComponentMappingMd{owners}};
+
+    Benchmark benchmark(&ctx);
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.RunBulkSameSet(&dsu, workload, GatherKernel::Auto);
+    DSU::EnableMetrics = false;
+
+    // queries of a block to the same owner share round trips
+    auto metrics = benchmark.CollectRawMetricStats(&dsu);
+    ASSERT_EQ(metrics.size(), 1);
+    EXPECT_EQ(metrics[0]["bulk_queries"], N - 3);
+    EXPECT_GT(metrics[0]["wire_round_trips"], 0);
+    EXPECT_LT(metrics[0]["wire_round_trips_per_op"], 0.5);
+}
+
+TEST(NBatchWireTest, RingKeepsBatchesInOrder) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    NBatchWire<2, 2> wire(&ctx);
+    auto twice = [](const int* requests, int* responses, int count) {
+        for (int k = 0; k < count; ++k)
+            responses[k] = 2 * requests[k];
+    };
+    int first[2] = {1, 2}, second[1] = {3}, responses[2];
+    EXPECT_TRUE(wire.Post(1, 0, first, 2));
+    EXPECT_TRUE(wire.Post(1, 0, second, 1));
+    EXPECT_EQ(wire.InFlight(1, 0), 2);
+    EXPECT_FALSE(wire.Post(1, 0, second, 1)); // the ring is full
+    EXPECT_EQ(wire.Serve(1, 0, twice), 2);
+
+    EXPECT_TRUE(wire.Await(1, 0, responses, 2, []{}, std::chrono::seconds(1)));
+    EXPECT_EQ(responses[0], 2);
+    EXPECT_EQ(responses[1], 4);
+    EXPECT_TRUE(wire.Await(1, 0, responses, 1, []{}, std::chrono::seconds(1)));
+    EXPECT_EQ(responses[0], 6);
+    EXPECT_EQ(wire.InFlight(1, 0), 0);
+
+    wire.Poison(1, WaitPolicy::Spin, twice);
+    EXPECT_FALSE(wire.Post(1, 0, first, 2));
+    wire.Reopen(1);
+    EXPECT_TRUE(wire.Post(1, 0, first, 2));
+}
+
+TEST(DsuRegistryTest, NamesMatchInstances) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    std::set<std::string> names;
+    for (const DsuVariant& variant : GetDsuVariants()) {
+        EXPECT_TRUE(names.insert(variant.Name).second) << variant.Name;
+        EXPECT_EQ(variant.Make(&ctx, 64)->ClassName(), variant.Name);
+        auto devirtualized = variant.MakeDevirtualized(&ctx, 64);
+        EXPECT_EQ(devirtualized->ClassName(), variant.Name);
+        EXPECT_NE(dynamic_cast<RequestRunner*>(devirtualized.get()), nullptr);
+    }
+
+    auto dsus = GetAvailableDsus(&ctx, 64, std::regex("Adaptive[23]/.*link-priority/.*"));
+    EXPECT_EQ(dsus.size(), 8);
+    for (const auto& dsu : dsus) {
+        EXPECT_NE(dynamic_cast<OwnershipAware*>(dsu.get()), nullptr) << dsu->ClassName();
+    }
+    EXPECT_EQ(GetAvailableDsus(&ctx, 64, std::regex("WireHelping3?/.*link-priority/.*")).size(), 8);
+
+    // the same mark selects one side of the compression knob in every family
+    auto count = [&names](const std::string& pattern) {
+        return std::count_if(names.begin(), names.end(), [&](const std::string& name) {
+            return std::regex_match(name, std::regex(pattern));
+        });
+    };
+    for (std::string family : {"Adaptive[23]", "AdaptiveSmart", "WireHelping3?"}) {
+        EXPECT_GT(count(family + "/.*local-compress/.*"), 0) << family;
+        EXPECT_GT(count(family + "/(?!.*local-compress/).*"), 0) << family;
+    }
+    EXPECT_EQ(count(".*cross-compress/.*"), 0);
+}
+
+TEST(RequestTest, PackedAndColumnLayoutsAgree) {
+    static_assert(sizeof(Request) == 8);
+    std::vector<Request> requests;
+    for (int i = 0; i < 200; ++i) {
+        requests.emplace_back(i % 3 == 0, INT_MAX - i, i);
+    }
+    RequestColumns columns(requests);
+    auto view = columns.All().subspan(5, 150);
+    ASSERT_EQ(view.size(), 150);
+    for (size_t i = 0; i < view.size(); ++i) {
+        const Request& expected = requests[i + 5];
+        EXPECT_EQ(view[i].IsSameSet(), (i + 5) % 3 == 0);
+        EXPECT_EQ(view[i].IsSameSet(), expected.IsSameSet());
+        EXPECT_EQ(view[i].U(), expected.U());
+        EXPECT_EQ(view[i].V(), expected.V());
+        EXPECT_EQ(expected.U(), INT_MAX - int(i + 5));
+    }
+}
+
+TEST(DevirtualizedTest, AppliesWorkload) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    Devirtualized<DSU_Adaptive<false, true>> dsu(&ctx, N);
+
+    // the preheat unites the first vertices, one by one or by BulkBuild
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, true, 100);
+
+    Benchmark benchmark(&ctx);
+    for (auto layout : {RequestLayout::AoS, RequestLayout::SoA}) {
+        for (bool bulkPreheat : {false, true}) {
+            SCOPED_TRACE(RequestLayoutName(layout) + (bulkPreheat ? " bulk preheat" : ""));
+            benchmark.SetRequestLayout(layout);
+            benchmark.SetBulkPreheat(bulkPreheat);
+            PrepareDSUForWorkload(&dsu, workload);
+            benchmark.Run(&dsu, workload);
+            ExpectModuloSets(dsu, 3);
+        }
+    }
+}
+
+TEST(DevirtualizedTest, SamplesLatenciesOnRequest) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    Devirtualized<DSU_Adaptive<false, true>> dsu(&ctx, N);
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, false);
+
+    Benchmark benchmark(&ctx);
+    for (bool sample : {false, true}) {
+        benchmark.SetLatencySampling(sample);
+        PrepareDSUForWorkload(&dsu, workload);
+        benchmark.Run(&dsu, workload);
+        auto metrics = benchmark.CollectRawMetricStats(&dsu);
+        ASSERT_EQ(metrics.size(), 1);
+        EXPECT_EQ(metrics[0].data().contains("latency_p50_ns"), sample);
+    }
+
+    // the open loop goes through the runner and times every request
+    benchmark.SetLatencySampling(false);
+    benchmark.SetArrivalRate(50'000);
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.Run(&dsu, workload);
+    ExpectModuloSets(dsu, 3);
+    auto hists = benchmark.CollectRawHistMetricStats(&dsu);
+    ASSERT_EQ(hists.size(), 3);
+    const auto& buckets = hists[2]["response_time_log2_ns"].data();
+    EXPECT_EQ(std::accumulate(buckets.begin(), buckets.end(), size_t(0)), N - 3);
+}
+
+TEST(BenchmarkTest, FixedDurationRun) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    DSU_Usual dsu(&ctx, N);
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4);
+
+    Benchmark benchmark(&ctx);
+    for (int durationMs : {0, 50}) {
+        benchmark.SetDuration(std::chrono::milliseconds(durationMs));
+        PrepareDSUForWorkload(&dsu, workload);
+        benchmark.Run(&dsu, workload);
+        ExpectModuloSets(dsu, 3);
+
+        auto timelines = benchmark.CollectTimelines(&dsu);
+        ASSERT_EQ(timelines.size(), 1);
+        ASSERT_EQ(timelines[0].size(), 4);
+        for (const ThreadTimeline& timeline : timelines[0]) {
+            auto [done, finish] = timeline.Progress.back();
+            EXPECT_EQ(timeline.Node, ctx.NumaNodeForThread(timeline.Thread));
+            EXPECT_TRUE(std::is_sorted(timeline.Progress.begin(), timeline.Progress.end()));
+            if (durationMs == 0) {
+                EXPECT_EQ(done, workload.ThreadRequests[timeline.Thread].size());
+            } else {
+                // cycled through the requests until stopped
+                EXPECT_GT(done, workload.ThreadRequests[timeline.Thread].size());
+                EXPECT_GE(finish, durationMs * 1'000'000ll);
+            }
+        }
+        auto metrics = benchmark.CollectMetricStats(&dsu);
+        EXPECT_GE(metrics["makespan_ms"].mean, durationMs);
+        EXPECT_GT(metrics["makespan_throughput"].mean, 0);
+        EXPECT_LE(metrics["completion_skew"].mean, 1);
+    }
+}
+
+TEST(BenchmarkTest, OpenLoopRun) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    DSU_Usual dsu(&ctx, N);
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, false);
+
+    // about 250 requests per thread at 50K per second take 5 ms
+    Benchmark benchmark(&ctx);
+    benchmark.SetArrivalRate(50'000);
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.Run(&dsu, workload);
+    ExpectModuloSets(dsu, 3);
+
+    auto metrics = benchmark.CollectMetricStats(&dsu);
+    EXPECT_EQ(metrics["offered_load"].mean, 200'000);
+    EXPECT_GT(metrics["makespan_ms"].mean, 2);
+    EXPECT_GT(metrics["latency_p50_ns"].mean, 0);
+    auto hists = benchmark.CollectRawHistMetricStats(&dsu);
+    ASSERT_EQ(hists.size(), 1);
+    const auto& buckets = hists[0]["response_time_log2_ns"].data();
+    EXPECT_EQ(std::accumulate(buckets.begin(), buckets.end(), size_t(0)), N - 3); // every request is measured
+}
+
+TEST(BenchmarkTest, TimedOpenLoopRunStopsOnTime) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 100'000;
+    DSU_Usual dsu(&ctx, N);
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, false);
+
+    // at 100 requests per second a chunk of the workload would take minutes
+    Benchmark benchmark(&ctx);
+    benchmark.SetArrivalRate(100);
+    benchmark.SetDuration(std::chrono::milliseconds(50));
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.Run(&dsu, workload);
+
+    auto metrics = benchmark.CollectMetricStats(&dsu);
+    EXPECT_GE(metrics["makespan_ms"].mean, 50);
+    EXPECT_LT(metrics["makespan_ms"].mean, 1000);
+}
+
+TEST(LatencyRecorderTest, KeepsBoundedSample) {
+    std::vector<LatencyRecorder> recorders(2);
+    for (uint32_t i = 1; i <= 4 * LatencyRecorder::CAPACITY; ++i) {
+        recorders[i % 2].Add(i);
+    }
+    EXPECT_EQ(recorders[0].Count() + recorders[1].Count(), 4 * LatencyRecorder::CAPACITY);
+    EXPECT_EQ(recorders[0].Buckets()[1] + recorders[1].Buckets()[1], 1); // the latency 1
+    EXPECT_DOUBLE_EQ(LatencyRecorder::Mean(recorders), (4 * LatencyRecorder::CAPACITY + 1) / 2.0);
+    double median = LatencyRecorder::Quantile(recorders, 0.5);
+    EXPECT_NEAR(median, 2 * LatencyRecorder::CAPACITY, 0.05 * LatencyRecorder::CAPACITY);
+}
+
+TEST(BenchmarkTest, SamplesMetricsDuringRun) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    DSU::EnableMetrics = true;
+    DSU_Usual dsu(&ctx, N);
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4);
+
+    Benchmark benchmark(&ctx);
+    benchmark.SetDuration(std::chrono::milliseconds(40));
+    benchmark.SetSamplingPeriod(std::chrono::milliseconds(5));
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.Run(&dsu, workload, true); // warmup is not sampled
+    benchmark.Run(&dsu, workload);
+    DSU::EnableMetrics = false;
+
+    auto runs = benchmark.CollectSamples(&dsu);
+    ASSERT_EQ(runs.size(), 1);
+    const auto& samples = runs[0];
+    ASSERT_GE(samples.size(), 2);
+    for (size_t i = 1; i < samples.size(); ++i) {
+        EXPECT_GT(samples[i].Time, samples[i - 1].Time);
+        EXPECT_GE(samples[i].Counters["union_requests"], samples[i - 1].Counters["union_requests"]);
+    }
+    auto totals = benchmark.CollectRawMetricStats(&dsu);
+    ASSERT_EQ(totals.size(), 1);
+    EXPECT_LE(samples.back().Counters["union_requests"], totals[0]["union_requests"]);
+    EXPECT_GT(totals[0]["union_requests"], 0);
+    EXPECT_FALSE(samples.back().Histograms.data().empty());
+}
+
+TEST(SequentialTest, RunsWorkloadOnOneThread) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 1000;
+    auto dsu = GetSequentialVariant().MakeDevirtualized(&ctx, N);
+    ASSERT_EQ(dsu->ClassName(), DSU_Sequential::Name());
+
+    // the preheat unites the first vertices
+    StaticWorkload workload = MakeModuloWorkload(N, 3, 4, true, 100);
+
+    Benchmark benchmark(&ctx);
+    for (auto layout : {RequestLayout::AoS, RequestLayout::SoA}) {
+        SCOPED_TRACE(RequestLayoutName(layout));
+        benchmark.SetRequestLayout(layout);
+        PrepareDSUForWorkload(dsu.get(), workload);
+        benchmark.RunSequential(dsu.get(), workload);
+        ExpectModuloSets(*dsu, 3);
+        EXPECT_EQ(benchmark.CollectRawThroughputStats(dsu.get()).size(), 1);
+    }
+
+    // there is no sequential counterpart of fixed-duration and open-loop runs
+    benchmark.SetDuration(std::chrono::milliseconds(10));
+    EXPECT_THROW(benchmark.RunSequential(dsu.get(), workload), std::runtime_error);
+}
+
+TEST(WorkersTest, PlacementAndComponents) {
+    NUMAContext ctx{4};
+    ctx.SetupForTests(8, 4);
+    ASSERT_EQ(ctx.WorkerCount(), 8);
+
+    ctx.SetWorkers(3, ThreadPlacement::Compact);
+    EXPECT_EQ(ctx.WorkerCount(), 3);
+    EXPECT_EQ(ctx.NumaNodeForThread(1), 0);
+    EXPECT_EQ(ctx.NumaNodeForThread(2), 1);
+    // service threads take CPUs the workers leave free, or share the last CPU of a full node
+    EXPECT_EQ(ctx.ServiceCpu(0), 1);
+    EXPECT_EQ(ctx.ServiceCpu(1), 3);
+
+    ctx.SetWorkers(3, ThreadPlacement::Spread);
+    for (int tid = 0; tid < 8; ++tid) {
+        EXPECT_EQ(ctx.NumaNodeForThread(tid), tid % 4);
+    }
+    EXPECT_EQ(ctx.ServiceCpu(0), 1);
+
+    // one component per node, owned by that node, whatever the worker count
+    ComponentsRandomWorkloadV2 provider;
+    StaticWorkload workload = provider.MakeWorkload(&ctx, ParseParameters({
+        "N=900", "E=3000", "ipf=0.2", "ssf=0", "shuffle=true", "preheat=0"
+    })[0]);
+    ASSERT_EQ(workload.ThreadRequests.size(), 3);
+    auto crossComponent = [](const StaticWorkload& workload) {
+        const auto& mapping = workload.GetMeta<ComponentMappingMd>().Mapping;
+        size_t count = 0;
+        for (const auto& requests : workload.ThreadRequests) {
+            count += std::count_if(requests.begin(), requests.end(), [&](const Request& r) {
+                return mapping[r.U()] != mapping[r.V()];
+            });
+        }
+        return count;
+    };
+    const auto& mapping = workload.GetMeta<ComponentMappingMd>().Mapping;
+    EXPECT_EQ(std::set<int>(mapping.begin(), mapping.end()), (std::set<int>{0, 1, 2, 3}));
+    for (int tid = 0; tid < 3; ++tid) {
+        size_t own = std::count_if(workload.ThreadRequests[tid].begin(), workload.ThreadRequests[tid].end(),
+                                   [&](const Request& r) { return mapping[r.U()] == tid && mapping[r.V()] == tid; });
+        EXPECT_GT(own, workload.ThreadRequests[tid].size() / 2);
+    }
+    EXPECT_EQ(crossComponent(workload), 600);
+
+    ctx.SetWorkers(1, ThreadPlacement::Compact);
+    workload = provider.MakeWorkload(&ctx, ParseParameters({
+        "N=900", "E=3000", "ipf=0.2", "ssf=0", "shuffle=true", "preheat=0"
+    })[0]);
+    ASSERT_EQ(workload.ThreadRequests.size(), 1);
+    EXPECT_EQ(workload.ThreadRequests[0].size(), 3000);
+    EXPECT_EQ(crossComponent(workload), 600);
+}
+
+TEST(RequestRouterTest, RoutedRequestsAreApplied) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 256;
+    DSU_Adaptive<true, false> dsu(&ctx, N);
+
+    StaticWorkload workload;
+    workload.N = N;
+    std::vector<int> owners(N);
+    for (int u = 0; u < N; ++u) {
+        owners[u] = u * 2 / N;
+    }
+    workload.Metadata.emplace_back(ComponentMappingMd{owners});
+    // even and odd vertices form two chains crossing the node boundary; thread t links u = t (mod 4)
+    workload.ThreadRequests.resize(4);
+    for (int u = 0; u + 2 < N; ++u) {
+        workload.ThreadRequests[u % 4].push_back({false, u + 2, u});
+        workload.ThreadRequests[(u + 1) % 4].push_back({true, u, u + 1});
+    }
+
+    Benchmark benchmark(&ctx);
+    benchmark.SetRouting(true);
+    PrepareDSUForWorkload(&dsu, workload);
+    benchmark.Run(&dsu, workload);
+
+    for (int u = 0; u + 2 < N; ++u) {
+        EXPECT_TRUE(dsu.SameSet(u, u + 2));
+        EXPECT_FALSE(dsu.SameSet(u, u + 1));
+    }
+    // a request is routed iff both its vertices are owned by the other node
+    size_t routed = 0, crossNode = 0, total = 0;
+    for (int tid = 0; tid < 4; ++tid) {
+        for (const Request& request : workload.ThreadRequests[tid]) {
+            int owner = owners[request.U()];
+            if (owner != owners[request.V()])
+                ++crossNode;
+            else if (owner != ctx.NumaNodeForThread(tid))
+                ++routed;
+            ++total;
+        }
+    }
+    ASSERT_GT(crossNode, 0);
+    auto metrics = benchmark.CollectMetricStats(&dsu);
+    EXPECT_DOUBLE_EQ(metrics["routed_fraction"].mean, (double) routed / total);
+    EXPECT_DOUBLE_EQ(metrics["cross_node_fraction"].mean, (double) crossNode / total);
+    EXPECT_GT(metrics["latency_p99_ns"].mean, 0);
+}
+
+TEST(PairQueueTest, PairsSurviveTransfer) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    PairQueue<FAAArrayQueue> queue(&ctx, 1);
+    constexpr int N = 5000;
+
+    std::vector<std::vector<std::pair<int, int>>> popped(4);
+    std::atomic<int> poppedTotal{0};
+    ctx.StartNThreads([&]() {
+        int tid = NUMAContext::CurrentThreadId();
+        if (tid < 2) {
+            for (int i = 0; i < N; ++i) {
+                queue.Push(tid == 0 ? i : (1 << 30) + i, tid == 0 ? 0 : INT_MAX - i);
+            }
+        }
+        int u, v;
+        while (poppedTotal.load() < 2 * N) {
+            if (queue.TryPop(u, v)) {
+                popped[tid].emplace_back(u, v);
+                ++poppedTotal;
+            }
+        }
+    }, 4);
+    ctx.Join();
+
+    std::set<std::pair<int, int>> all;
+    for (const auto& pairs : popped)
+        all.insert(pairs.begin(), pairs.end());
+    ASSERT_EQ((int) all.size(), 2 * N);
+    for (int i = 0; i < N; ++i) {
+        EXPECT_TRUE(all.count({i, 0}));
+        EXPECT_TRUE(all.count({(1 << 30) + i, INT_MAX - i}));
+    }
+}
+
+TEST(AdaptiveTest, CompactionDaemonKeepsSets) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    constexpr int N = 3000;
+    DSU_Adaptive<true, false> dsu(&ctx, N);
+    for (int u = N / 2; u < N; ++u) {
+        dsu.SetOwner(u, 1);
+    }
+    dsu.SetCompactionDaemon(true);
+
+    // vertices with equal u % 7 form a set; the daemon sweeps while the unions run
+    ctx.StartNThreads([&]() {
+        int tid = NUMAContext::CurrentThreadId();
+        for (int u = tid; u + 7 < N; u += 4) {
+            dsu.Union(N - 1 - u, N - 8 - u);
+        }
+    }, 4);
+    ctx.Join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    ctx.StartNThreads([&]() {
+        ExpectModuloSets(dsu, 7);
+    }, 4);
+    ctx.Join();
+    dsu.SetCompactionDaemon(false);
+}
+
+// node 1 finds vertex 1, a child of root 0, both owned by node 0; the metrics after every find
+template <ReplicationPolicy Replication>
+std::vector<Metrics> RemoteFinds(int finds) {
+    NUMAContext ctx{2};
+    ctx.SetupForTests(4, 2);
+    DSU::EnableMetrics = true;
+    DSU_Adaptive<true, false, true, Replication> dsu(&ctx, 64);
+    dsu.Union(1, 0);
+
+    std::vector<Metrics> after;
+    for (int i = 0; i < finds; ++i) {
+        ctx.StartNThreads([&]() {
+            DSU& base = dsu;
+            if (NUMAContext::CurrentThreadId() == 2) {
+                EXPECT_EQ(base.Find(1), 0);
+            }
+        }, 3);
+        ctx.Join();
+        after.push_back(dsu.collectMetrics());
+    }
+    DSU::EnableMetrics = false;
+    return after;
+}
+
+TEST(ReplicationTest, AfterKReplicatesOnKthRemoteRead) {
+    std::vector<Metrics> after = RemoteFinds<ReplicationPolicy::AfterK>(REPLICATION_AFTER_K + 2);
+    for (int i = 0; i < REPLICATION_AFTER_K; ++i) {
+        EXPECT_EQ(after[i]["replicated"], i + 1 == REPLICATION_AFTER_K ? 1 : 0) << "find #" << i;
+    }
+    // the replica serves the vertex itself; only the root is read remotely
+    size_t last = REPLICATION_AFTER_K + 1;
+    EXPECT_EQ(after[last]["replicated"], 1);
+    EXPECT_EQ(after[last]["cross_node_read"] - after[last - 1]["cross_node_read"], 1);
+}
+
+TEST(ReplicationTest, NeverKeepsReadingRemotely) {
+    std::vector<Metrics> after = RemoteFinds<ReplicationPolicy::Never>(2 * REPLICATION_AFTER_K);
+    for (size_t i = 1; i < after.size(); ++i) {
+        EXPECT_EQ(after[i]["replicated"], 0) << "find #" << i;
+        EXPECT_EQ(after[i]["cross_node_read"] - after[i - 1]["cross_node_read"], 2) << "find #" << i;
+    }
+}
+
+template <class T>
+class PriorityLinkingTest : public DSUTest<T> {};
+
+using PriorityLinkingDsus = ::testing::Types<
+        DSU_Adaptive<true, false, true, ReplicationPolicy::Always, LinkingPolicy::ByPriority>,
+        DSU_Adaptive<false, true, true, ReplicationPolicy::Always, LinkingPolicy::ByPriority>,
+        DSU_Adaptive<true, true, false, ReplicationPolicy::Always, LinkingPolicy::ByPriority>,
+        DSU_WireHelping<true, false, false, false, LinkingPolicy::ByPriority>,
+        DSU_WireHelping<false, true, true, false, LinkingPolicy::ByPriority>>;
+TYPED_TEST_SUITE(PriorityLinkingTest, PriorityLinkingDsus);
+
+TYPED_TEST(PriorityLinkingTest, RootsHaveHighestPriority) {
+    this->Ctx_.SetupForTests(4, 2);
+    constexpr int N = 2000;
+    auto dsu = this->MakeDSU(N);
+    for (int u = N / 2; u < N; ++u) {
+        dsu->SetOwner(u, 1);
+    }
+
+    // vertices with equal u % 5 form a set
+    this->Ctx_.StartNThreads([&]() {
+        int tid = NUMAContext::CurrentThreadId();
+        for (int u = tid; u + 5 < N; u += 4) {
+            dsu->Union(u, u + 5);
+        }
+    }, 4);
+    this->Ctx_.Join();
+
+    this->Ctx_.StartNThreads([&]() {
+        ExpectModuloSets(*dsu, 5);
+    }, 4);
+    this->Ctx_.Join();
+
+    std::vector<int> best(5, -1);
+    for (int u = 0; u < N; ++u) {
+        if (best[u % 5] < 0 || LinkPriority(u) > LinkPriority(best[u % 5]))
+            best[u % 5] = u;
+    }
+    for (int u = 0; u < N; u += 7) {
+        EXPECT_EQ(static_cast<DSU*>(dsu.get())->Find(u), best[u % 5]);
+    }
+}
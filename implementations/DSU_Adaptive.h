@@ -2,23 +2,41 @@
 
 #include "../DSU.h"
 #include "../lib/util.hpp"
+#include "../lib/afforest.hpp"
+#include "../lib/replication.hpp"
+#include "../lib/linking.hpp"
 
 #include <array>
+#include <chrono>
 #include <sstream>
+#include <thread>
 
+#include <pthread.h>
+#include <sched.h>
 
-template <bool Halfing, bool Stepping, bool AllowCrossNodeCompression=true>
-class DSU_Adaptive : public DSU {
+
+template <bool Halfing, bool Stepping, bool AllowCrossNodeCompression=true,
+          ReplicationPolicy Replication=ReplicationPolicy::Always, LinkingPolicy Linking=LinkingPolicy::ByIndex>
+class DSU_Adaptive : public DSU, public OwnershipAware {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         using namespace std::string_literals;
         int version = Stepping ? 3 : 2;
-        return "Adaptive"s + std::to_string(version) +  "/"s +
+        std::string replication = Replication == ReplicationPolicy::Always ? ""s
+                : "replicate-"s + ReplicationPolicyName(Replication) + "/"s;
+        std::string compression = AllowCrossNodeCompression ? ""s : "local-compress/"s;
+        std::string linking = Linking == LinkingPolicy::ByIndex ? ""s
+                : "link-"s + LinkingPolicyName(Linking) + "/"s;
+        return "Adaptive"s + std::to_string(version) +  "/"s + replication + compression + linking +
             (Halfing ? "halfing" : "squashing");
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     DSU_Adaptive(NUMAContext* ctx, int size)
-        : DSU(ctx)
+        : DSU(ctx, ctx->MaxConcurrency() + ctx->NodeCount()) // with compaction daemons
         , size(size), node_count(ctx->NodeCount()) {
         using namespace std::string_literals;
         REQUIRE(size <= MAX_VERTICES, "Max supported size: "s + std::to_string(MAX_VERTICES)
@@ -27,22 +45,101 @@ public:
         data.resize(node_count);
         for (int i = 0; i < node_count; i++) {
             data[i] = (std::atomic<int> *) Ctx_->Allocate(i, sizeof(std::atomic<int>) * size);
+            if constexpr (Replication == ReplicationPolicy::AfterK)
+                sketches.emplace_back(std::make_unique<RemoteReadSketch>(ctx, i, size));
+            if (EnableMetrics)
+                freshReplicas.emplace_back(std::make_unique<std::atomic<bool>[]>(size));
         }
         doReInit();
     }
 
+    // stops the compaction daemon
     void ReInit() override {
+        stopDaemons();
         doReInit();
     }
 
-    void SetOwner(int v, int node) {
+    int Size() const override {
+        return size;
+    }
+
+    void SetOwner(int v, int node) override {
         for (int i = 0; i < node_count; i++) {
             int par = data[i][v].load(std::memory_order_relaxed);
             data[i][v].store(makeData(getDataParent(par), 1 << node, true), std::memory_order_relaxed);
         }
     }
 
+    // one sequential pass per replica
+    void SetOwners(std::span<const int> owners) override {
+        for (int i = 0; i < node_count; i++) {
+            for (int v = 0; v < (int) owners.size(); ++v) {
+                int par = data[i][v].load(std::memory_order_relaxed);
+                data[i][v].store(makeData(getDataParent(par), 1 << owners[v], true), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * Runs Afforest on top of the current sets and writes the result straight into the replicas:
+     * a root keeps its current owner, a non-root points to its root and is replicated on every node.
+     * Afforest hangs larger indices below smaller ones, so other linking policies take the generic path.
+     */
+    void BulkBuild(std::span<const VertexPair> edges) override {
+        if constexpr (Linking != LinkingPolicy::ByIndex) {
+            DSU::BulkBuild(edges);
+            return;
+        }
+        REQUIRE(!IsFrozen(), "BulkBuild of a frozen DSU; call Thaw() first");
+        bool daemons = stopDaemons();
+        std::vector<int8_t> owners(size);
+        Afforest(Ctx_).Run(size, edges, [this, &owners](int u) {
+            int node = NUMAContext::CurrentThreadNode();
+            size_t depth = 0;
+            owners[u] = (int8_t) getAnyDataOwnerId(readDataChecked(node, u));
+            return getDataParent(find(u, node, false, depth));
+        }, [this, &owners](int u, int root) {
+            int owner = owners[u];
+            for (int i = 0; i < node_count; i++) {
+                int dataOwners = root == u ? 1 << owner : (1 << owner) | (1 << i);
+                data[i][u].store(makeData(root, dataOwners, true), std::memory_order_relaxed);
+            }
+        });
+        if (daemons)
+            SetCompactionDaemon(true);
+    }
+
+    /*
+     * One SCHED_IDLE service thread per node sweeps the node's replica in chunks:
+     * local non-roots are pointed straight at their current roots, and remote non-roots are replicated
+     * locally the same way, so queries mostly see local paths of depth 1.
+     * A pass that changes nothing puts the daemon to sleep, twice as long after every further idle pass.
+     */
+    void SetCompactionDaemon(bool enabled) override {
+        if (!enabled) {
+            stopDaemons();
+            return;
+        }
+        if (!daemons.empty())
+            return;
+        daemonStop.store(false);
+        for (int node = 0; node < node_count; ++node) {
+            daemons.push_back(Ctx_->StartServiceThread(node, [this, node]() {
+                compactionDaemon(node);
+            }));
+        }
+    }
+
+    // Adaptive gives every worker thread its own CompactionController
+    void SetCompaction(CompactionPolicy policy) override {
+        DSU::SetCompaction(policy);
+        for (auto& controller : controllers) {
+            controller.Reset();
+        }
+    }
+
     ~DSU_Adaptive() override {
+        stopDaemons();
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(int) * size);
         }
@@ -62,8 +159,47 @@ protected:
     void DoUnion(int u, int v) override {
         DepthStats uStats, vStats;
 
-        DoUnionWithStats(u, v, uStats, vStats);
+        DoUnionWithStats(u, v, uStats, vStats, false);
+
+        incDepthHists(uStats, vStats);
+    }
+
+    UnionResult DoTryUnion(int u, int v) override {
+        DepthStats uStats, vStats;
+
+        UnionResult r = DoUnionWithStats(u, v, uStats, vStats, true);
+
+        incDepthHists(uStats, vStats);
+        return r;
+    }
 
+    /*
+     * Walks up from whichever vertex may lie below the other, so the common part of the paths is read once:
+     * the walk stops where the paths meet or at a root, which the other vertex cannot lie below.
+     */
+    std::pair<int, int> FindPair(int u, int v) override {
+        int node = NUMAContext::CurrentThreadNode();
+        size_t depth = 0;
+        bool swapped = false;
+        while (u != v) {
+            if (LinksBelow<Linking>(v, u)) {
+                std::swap(u, v);
+                swapped = !swapped;
+            }
+            ++depth;
+            int par = getDataParent(readDataChecked(node, u));
+            if (par == u)
+                break;
+            u = par;
+        }
+        int uRoot = getDataParent(find(u, node, compacting(), depth));
+        int vRoot = u == v ? uRoot : getDataParent(find(v, node, compacting(), depth));
+        recordOp(depth, 2);
+        return swapped ? std::make_pair(vRoot, uRoot) : std::make_pair(uRoot, vRoot);
+    }
+
+    void incDepthHists(const DepthStats& uStats, const DepthStats& vStats) {
+        recordOp(uStats.total() + vStats.total(), 2);
         mHistLocalFindDepth.inc(uStats.local);
         mHistLocalFindDepth.inc(vStats.local);
         mHistCrossNodeFindDepth.inc(uStats.crossNode);
@@ -72,7 +208,8 @@ protected:
         mHistFindDepth.inc(vStats.total());
     }
 
-    void DoUnionWithStats(int u, int v, DepthStats& uStats, DepthStats& vStats) {
+    // the root is looked up for unmerged sets only if `needRoot` is set
+    UnionResult DoUnionWithStats(int u, int v, DepthStats& uStats, DepthStats& vStats, bool needRoot) {
         auto node = NUMAContext::CurrentThreadNode();
         // TODO try this optimization with node owners
 //        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
@@ -82,16 +219,16 @@ protected:
         u = findLocalOnly(u, node, u_, uStats.local);
         v = findLocalOnly(v, node, v_, vStats.local);
         if (u == v)
-            return;
+            return {false, needRoot ? getDataParent(find(u, node, compacting(), uStats.crossNode)) : u};
         while (true) {
-            int uDat = find(u, node, EnableCompaction, uStats.crossNode);
+            int uDat = find(u, node, compacting(), uStats.crossNode);
             u = getDataParent(uDat);
-            int vDat = find(v, node, EnableCompaction, vStats.crossNode);
+            int vDat = find(v, node, compacting(), vStats.crossNode);
             v = getDataParent(vDat);
             if (u == v) {
-                return;
+                return {false, u};
             }
-            if (u < v) { // TODO try implicit pseudorandom priorities
+            if (LinksBelow<Linking>(v, u)) {
                 std::swap(u, v);
                 std::swap(uDat, vDat);
                 if (DSU::EnableMetrics) {
@@ -108,7 +245,7 @@ protected:
                 mCrossNodeWrite.inc(1);
             }
             if (data[owner][u].compare_exchange_strong(uDat, makeData(v, 1 << owner, true)))
-                break;
+                return {true, v};
         }
     }
 
@@ -138,6 +275,7 @@ protected:
         mHistCrossNodeFindDepth.inc(vStats.crossNode);
         mHistFindDepth.inc(uStats.total());
         mHistFindDepth.inc(vStats.total());
+        recordOp(uStats.total() + vStats.total(), 2);
 
         return r;
     }
@@ -149,7 +287,7 @@ protected:
         while (true) {
             if (u == v)
                 return true;
-            if (u < v) {
+            if (LinksBelow<Linking>(v, u)) {
                 std::swap(u, v);
                 std::swap(prevU, prevV);
                 std::swap(prevUDat, prevVDat);
@@ -160,36 +298,39 @@ protected:
             int par = getDataParent(parDat);
             ++(isDataOwner(parDat, node) ? stats.local : stats.crossNode);
 
-            if (EnableCompaction && prevU != u) {
-                // ordinary compaction
-                mThisNodeWrite.inc(1);
-                data[node][prevU].store(mixDataOwner(parDat, node));
+            if (compacting() && prevU != u) {
+                if (isDataOwner(prevUDat, node)) {
+                    // ordinary compaction
+                    countWrite();
+                    data[node][prevU].store(mixDataOwner(parDat, node));
+                } else {
+                    replicate(node, prevU, mixDataOwner(parDat, node));
+                }
             }
-            if (!EnableCompaction && par != u && !isDataOwner(localDat, node)) {
+            if (!compacting() && par != u && !isDataOwner(localDat, node)) {
                 // copy non-root vertex to local memory
-                mThisNodeWrite.inc(1);
-                data[node][u].store(mixDataOwner(parDat, node));
+                replicate(node, u, mixDataOwner(parDat, node));
             }
 
-            if (EnableCompaction && (par == u || par == v)) {
+            if (compacting() && (par == u || par == v)) {
                 // we are going to return
                 // copy non-root vertices to local memory
 
                 if (par != u && !isDataOwner(localDat, node)) {
-                    mThisNodeWrite.inc(1);
-                    data[node][u].store(mixDataOwner(parDat, node));
+                    replicate(node, u, mixDataOwner(parDat, node));
                 }
-                if (prevVDat && prevV != v && !isDataOwner(prevVDat, node)) {
-                    mThisNodeWrite.inc(1);
-                    data[node][prevV].compare_exchange_strong(
-                            prevVDat,makeData(v, (1 << node) | getDataOwners(prevVDat), true));
+                if (prevVDat && prevV != v && !isDataOwner(prevVDat, node) && shouldReplicate(node, prevV)) {
+                    countWrite();
+                    if (data[node][prevV].compare_exchange_strong(
+                            prevVDat,makeData(v, (1 << node) | getDataOwners(prevVDat), true)))
+                        markReplicated(node, prevV);
                 }
             }
 
             if (par == v)
                 return true;
             if (par == u) // u is root
-                // u cannot be the root of v, because v < u
+                // u cannot be the root of v, because v precedes u in the linking order
                 return false;
 
             prevU = u;
@@ -204,7 +345,7 @@ protected:
         while (true) {
             if (u == v)
                 return true;
-            if (!freeze && u < v)
+            if (!freeze && LinksBelow<Linking>(v, u))
                 std::swap(u, v);
             int localDat, localParDat;
             int parDat = readDataChecked(node, u, localDat);
@@ -218,8 +359,7 @@ protected:
             if (par == grand) {
                 if (par != u && !isDataOwner(localDat, node)) {
                     // copy non-root vertex to local memory
-                    mThisNodeWrite.inc(1);
-                    data[node][u].store(mixDataOwner(parDat, node));
+                    replicate(node, u, mixDataOwner(parDat, node));
                 }
                 if (freeze) {
                     int vCur = readDataChecked(node, v);
@@ -233,15 +373,13 @@ protected:
                     continue;
                 }
             } else {
-                if (!EnableCompaction) {
+                if (!compacting()) {
                     if (!isDataOwner(localDat, node)) {
                         // copy non-root vertex to local memory
-                        mThisNodeWrite.inc(1);
-                        data[node][u].store(mixDataOwner(parDat, node));
+                        replicate(node, u, mixDataOwner(parDat, node));
                     }
                     if (!isDataOwner(localParDat, node)) {
-                        mThisNodeWrite.inc(1);
-                        data[node][par].store(mixDataOwner(grandDat, node));
+                        replicate(node, par, mixDataOwner(grandDat, node));
                     }
                     u = grand;
                     continue;
@@ -250,7 +388,7 @@ protected:
                 if (isDataOwner(localDat, node)) {
                     if (AllowCrossNodeCompression || isDataOwner(localParDat, node)) {
                         // compress local if we know `par`
-                        mThisNodeWrite.inc(1);
+                        countWrite();
                         data[node][u].store(mixDataOwner(grandDat, node));
                     } else {
                         u = par;
@@ -258,8 +396,7 @@ protected:
                     }
                 } else {
                     // copy non-root vertex to local memory
-                    mThisNodeWrite.inc(1);
-                    data[node][u].store(mixDataOwner(grandDat, node));
+                    replicate(node, u, mixDataOwner(grandDat, node));
                 }
             }
             if constexpr(Halfing) {
@@ -310,15 +447,17 @@ protected:
             if (!firstIter && getDataParent(readDataChecked(node, u)) == u) {
                 return false;
             }
-            uDat = find(u, node, EnableCompaction, uStats.crossNode);
-            vDat = find(v, node, EnableCompaction, vStats.crossNode);
+            uDat = find(u, node, compacting(), uStats.crossNode);
+            vDat = find(v, node, compacting(), vStats.crossNode);
             firstIter = false;
         }
     }
 
     int Find(int u) override {
         size_t depth = 0;
-        return getDataParent(find(u, NUMAContext::CurrentThreadNode(), EnableCompaction, depth));
+        int root = getDataParent(find(u, NUMAContext::CurrentThreadNode(), compacting(), depth));
+        recordOp(depth, 1);
+        return root;
     }
 
 private:
@@ -332,9 +471,10 @@ private:
                 localParDat = parDat;
                 return u;
             }
+            noteLocalRead(node, u);
             int par = getDataParent(parDat);
 
-            if (!DSU::EnableCompaction) {
+            if (!compacting()) {
                 if (par == u) {
                     localParDat = parDat;
                     return u;
@@ -356,10 +496,10 @@ private:
                 return par;
             } else {
                 // compress local
-                mThisNodeWrite.inc(1);
+                countWrite();
                 data[node][u].store(grandDat);
             }
-            if constexpr(Halfing) {
+            if (halving()) {
                 u = grand;
                 ++depth;
             } else {
@@ -381,15 +521,14 @@ private:
                 if (par == grand) {
                     if (par != u && !isDataOwner(parDat, node)) {
                         // copy non-root vertex to local memory
-                        mThisNodeWrite.inc(1);
-                        data[node][u].store(mixDataOwner(parDat, node));
+                        replicate(node, u, mixDataOwner(parDat, node));
                     }
                     return grandDat;
                 } else {
                     if (isDataOwner(localDat, node)) {
                         if (AllowCrossNodeCompression || isDataOwner(grandDat, node)) {
                             // compress local if we know about `par`
-                            mThisNodeWrite.inc(1);
+                            countWrite();
                             data[node][u].store( mixDataOwner(grandDat, node));
                         } else {
                             u = par; // else do not compress, but go to par even if Halfing enabled
@@ -397,11 +536,10 @@ private:
                         }
                     } else {
                         // copy non-root vertex to local memory
-                        mThisNodeWrite.inc(1);
-                        data[node][u].store(mixDataOwner(grandDat, node));
+                        replicate(node, u, mixDataOwner(grandDat, node));
                     }
                 }
-                if constexpr(Halfing) {
+                if (halving()) {
                     u = grand;
                     ++depth;
                 } else {
@@ -422,6 +560,8 @@ private:
         }
     }
 
+protected:
+    // owner and replica helpers, shared with the implementations built on top of this layout
     inline int readDataChecked(int primaryNode, int u) const {
         int localData;
         return readDataChecked(primaryNode, u, localData);
@@ -432,6 +572,7 @@ private:
         mThisNodeRead.inc(1);
         if (isDataOwner(localData, primaryNode)) {
             mThisNodeReadSuccess.inc(1);
+            noteLocalRead(primaryNode, u);
             return localData;
         }
 
@@ -449,7 +590,161 @@ private:
         return dat;
     }
 
+private:
+    // returns true if the daemons were running
+    bool stopDaemons() {
+        if (daemons.empty())
+            return false;
+        daemonStop.store(true);
+        for (auto& daemon : daemons) {
+            daemon.join();
+        }
+        daemons.clear();
+        return true;
+    }
+
+    void compactionDaemon(int node) {
+        sched_param param{};
+        if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+            mDaemonNotIdle.inc(1); // competes with the workers at the normal priority
+
+        int u = 0;
+        size_t passWrites = 0;
+        auto idleSleep = DAEMON_IDLE_SLEEP;
+        while (!daemonStop.load(std::memory_order_relaxed)) {
+            int end = std::min(size, u + DAEMON_CHUNK);
+            mDaemonSwept.inc(end - u);
+            for (; u < end; ++u) {
+                passWrites += sweepVertex(u, node);
+            }
+            if (u == size) {
+                u = 0;
+                if (passWrites == 0) {
+                    // slept in steps of DAEMON_IDLE_SLEEP to notice the stop
+                    for (auto slept = idleSleep.zero(); slept < idleSleep && !daemonStop.load(std::memory_order_relaxed);
+                            slept += DAEMON_IDLE_SLEEP) {
+                        std::this_thread::sleep_for(DAEMON_IDLE_SLEEP);
+                    }
+                    idleSleep = std::min(idleSleep * 2, DAEMON_MAX_IDLE_SLEEP);
+                } else {
+                    idleSleep = DAEMON_IDLE_SLEEP;
+                }
+                passWrites = 0;
+            }
+        }
+    }
+
+    // returns true if the local entry of `u` was written
+    bool sweepVertex(int u, int node) {
+        int localDat = data[node][u].load(std::memory_order_relaxed);
+        bool local = isDataOwner(localDat, node);
+        int dat = local ? localDat : readDataUnsafe(getAnyDataOwnerId(localDat), u);
+        int root = getDataParent(dat);
+        if (root == u)
+            return false; // roots have exactly one owner and are never replicated
+
+        int rootDat;
+        while (true) {
+            int parDat = data[node][root].load(std::memory_order_relaxed);
+            if (!isDataOwner(parDat, node))
+                parDat = readDataUnsafe(getAnyDataOwnerId(parDat), root);
+            if (getDataParent(parDat) == root) {
+                rootDat = parDat;
+                break;
+            }
+            root = getDataParent(parDat);
+        }
+        if (local && getDataParent(localDat) == root)
+            return false;
+        if constexpr (Replication == ReplicationPolicy::Never) {
+            if (!local)
+                return false;
+        } else if constexpr (Replication == ReplicationPolicy::AfterK) {
+            if (!local && !sketches[node]->Check(u, REPLICATION_AFTER_K))
+                return false; // only hot remote vertices are replicated ahead of the queries
+        }
+
+        // any ancestor is a valid parent; if a query has just written the entry, it keeps its value
+        if (!data[node][u].compare_exchange_strong(localDat, mixDataOwner(rootDat, node)))
+            return false;
+        mDaemonWrite.inc(1);
+        if (!local)
+            markReplicated(node, u);
+        return true;
+    }
+
+    CompactionMode compactionMode() const {
+        switch (Compaction_) {
+            case CompactionPolicy::Full: return CompactionMode::Full;
+            case CompactionPolicy::Halving: return CompactionMode::Halving;
+            case CompactionPolicy::None: return CompactionMode::None;
+            case CompactionPolicy::Adaptive: return controllers[NUMAContext::CurrentThreadId()].Mode();
+        }
+        return CompactionMode::Full;
+    }
+
+    bool compacting() const {
+        return compactionMode() != CompactionMode::None;
+    }
+
+    bool halving() const {
+        return Halfing || compactionMode() == CompactionMode::Halving;
+    }
+
+    // compaction and replication writes; they are what the adaptive controller weighs against find depth
+    void countWrite() {
+        mThisNodeWrite.inc(1);
+        if (Compaction_ == CompactionPolicy::Adaptive)
+            controllers[NUMAContext::CurrentThreadId()].CountWrite();
+    }
+
+    void recordOp(size_t depth, size_t finds) {
+        if (Compaction_ == CompactionPolicy::Adaptive
+                && controllers[NUMAContext::CurrentThreadId()].Record(depth, finds))
+            mCompactionSwitches.inc(1);
+    }
+
+    // whether a remotely read non-root `u` is copied into the replica of `node`; counts the read if needed
+    bool shouldReplicate(int node, int u) {
+        if constexpr (Replication == ReplicationPolicy::Always) {
+            return true;
+        } else if constexpr (Replication == ReplicationPolicy::Never) {
+            return false;
+        } else {
+            return sketches[node]->CountAndCheck(u, REPLICATION_AFTER_K);
+        }
+    }
+
+    void replicate(int node, int u, int dat) {
+        if (!shouldReplicate(node, u))
+            return;
+        countWrite();
+        data[node][u].store(dat);
+        markReplicated(node, u);
+    }
+
+    // replicas are tracked until their first local read to tell reused copies from wasted ones
+    void markReplicated(int node, int u) {
+        if (!EnableMetrics)
+            return;
+        mReplicated.inc(1);
+        if (!freshReplicas.empty())
+            freshReplicas[node][u].store(true, std::memory_order_relaxed);
+    }
+
+    void noteLocalRead(int node, int u) const {
+        if (EnableMetrics && !freshReplicas.empty() && freshReplicas[node][u].load(std::memory_order_relaxed)
+                && freshReplicas[node][u].exchange(false, std::memory_order_relaxed))
+            mReplicatedReused.inc(1);
+    }
+
     void doReInit() {
+        for (auto& sketch : sketches) {
+            sketch->Reset();
+        }
+        for (auto& fresh : freshReplicas) {
+            std::fill(fresh.get(), fresh.get() + size, false);
+        }
         for (int i = 0; i < node_count; i++) {
             for (int j = 0; j < size; j++) {
                 data[i][j].store(makeData(j, 1, true));
@@ -457,6 +752,7 @@ private:
         }
     }
 
+protected:
     static inline bool getDataFinalized(int d) {
         return d & M_FINALIZED;
     }
@@ -485,10 +781,29 @@ private:
         return data | ((1 << ownerId) << M_SHIFT_OWNERS);
     }
 
+private:
     int size;
     int node_count;
     std::vector<std::atomic<int>*> data;
 
+    std::vector<CompactionController> controllers = std::vector<CompactionController>(Ctx_->MaxConcurrency());
+    MetricsCollector::Accessor mCompactionSwitches = accessor("compaction_switches");
+
+    std::vector<std::unique_ptr<RemoteReadSketch>> sketches; // per node, AfterK only
+    std::vector<std::unique_ptr<std::atomic<bool>[]>> freshReplicas; // per node, with metrics only
+    MetricsCollector::Accessor mReplicated = accessor("replicated");
+    MetricsCollector::Accessor mReplicatedReused = accessor("replicated_reused");
+
+    std::vector<std::thread> daemons;
+    std::atomic<bool> daemonStop{false};
+    MetricsCollector::Accessor mDaemonSwept = accessor("daemon_swept");
+    MetricsCollector::Accessor mDaemonWrite = accessor("daemon_write");
+    MetricsCollector::Accessor mDaemonNotIdle = accessor("daemon_not_idle");
+
+    static constexpr int DAEMON_CHUNK = 4096;
+    static constexpr std::chrono::milliseconds DAEMON_IDLE_SLEEP{1};
+    static constexpr std::chrono::milliseconds DAEMON_MAX_IDLE_SLEEP{64};
+
     static constexpr int MAX_NUMA_NODES = 4;
     static constexpr int MAX_VERTICES = (1 << (31 - MAX_NUMA_NODES)) - 1;
     static constexpr int M_FINALIZED = 1 << 31;
@@ -6,24 +6,45 @@
 #include <array>
 
 
-template <bool Halfing>
-class DSU_AdaptiveLocks : public DSU {
+/*
+ * The lock of a root lives in `to_union` of its home node (the lowest owner of the root),
+ * so locking a node-local root does not leave the node.
+ *
+ * With Cohort every node also has a local lock word per vertex: a thread takes the local lock
+ * of its node before touching the global word, so at most one thread per node contends for a root
+ * and the others wait on node-local memory. A root lock is never handed over within the cohort:
+ * once the union is done the vertex is not a root anymore, and the waiters only have to find the new root.
+ */
+template <bool Halfing, bool Cohort = false>
+class DSU_AdaptiveLocks : public DSU, public OwnershipAware {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         using namespace std::string_literals;
-        return "AdaptiveLocks/"s + (Halfing ? "halfing" : "squashing");
+        return "AdaptiveLocks/"s + (Cohort ? "cohort/" : "") + (Halfing ? "halfing" : "squashing");
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     DSU_AdaptiveLocks(NUMAContext* ctx, int size)
             : DSU(ctx)
-            , size(size), node_count(ctx->NodeCount()), to_union(size) {
+            , size(size), node_count(ctx->NodeCount()) {
         using namespace std::string_literals;
         REQUIRE(size <= MAX_VERTICES, "Max supported size: "s + std::to_string(MAX_VERTICES)
                                       + "; given size "s + std::to_string(size));
 
         data.resize(node_count);
+        to_union.resize(node_count);
         for (int i = 0; i < node_count; i++) {
             data[i] = (std::atomic<int> *) Ctx_->Allocate(i, sizeof(std::atomic<int>) * size);
+            to_union[i] = (std::atomic<int> *) Ctx_->Allocate(i, sizeof(std::atomic<int>) * size);
+        }
+        if constexpr (Cohort) {
+            cohort.resize(node_count);
+            for (int i = 0; i < node_count; i++) {
+                cohort[i] = (std::atomic<int> *) Ctx_->Allocate(i, sizeof(std::atomic<int>) * size);
+            }
         }
         doReInit();
     }
@@ -32,7 +53,11 @@ public:
         doReInit();
     }
 
-    void SetOwner(int v, int node) {
+    int Size() const override {
+        return size;
+    }
+
+    void SetOwner(int v, int node) override {
         for (int i = 0; i < node_count; i++) {
             int par = data[i][v].load(std::memory_order_relaxed);
             data[i][v].store(makeData(getDataParent(par), 1 << node, true), std::memory_order_relaxed);
@@ -42,6 +67,10 @@ public:
     ~DSU_AdaptiveLocks() override {
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(int) * size);
+            Ctx_->Free(to_union[i], sizeof(int) * size);
+        }
+        for (auto* words : cohort) {
+            Ctx_->Free(words, sizeof(int) * size);
         }
     }
 
@@ -51,6 +80,7 @@ public:
 //        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
 //            return;
 //        }
+        Waiter waiter(WaitPolicy_);
         while (true) {
             int uDat = find(u, node, true);
             u = getDataParent(uDat);
@@ -63,16 +93,23 @@ public:
                 std::swap(u, v);
                 std::swap(uDat, vDat);
             }
-            mGlobalDataAccess.inc(1);
-            auto uUnionData = to_union[u].load(std::memory_order_acquire);
+            if constexpr (Cohort) {
+                if (!lockCohort(u, node, waiter))
+                    continue;
+            }
+            int home = getAnyDataOwnerId(uDat);
+            std::atomic<int>& uLock = to_union[home][u];
+            (home == node ? mThisNodeRead : mCrossNodeRead).inc(1);
+            auto uUnionData = uLock.load(std::memory_order_acquire);
             if (uUnionData != u * 2 + 1) {
-#if defined(__x86_64__)
-                __builtin_ia32_pause();
-#endif
+                if constexpr (Cohort)
+                    unlockCohort(u, node);
+                if (!(uUnionData & 1)) // locked by another union
+                    waiter.Wait(uLock, uUnionData);
                 continue;
             } else {
-                mGlobalDataAccess.inc(1);
-                if (to_union[u].compare_exchange_strong(uUnionData, v * 2)) { // lock
+                (home == node ? mThisNodeWrite : mCrossNodeWrite).inc(1);
+                if (uLock.compare_exchange_strong(uUnionData, v * 2)) { // lock
                     int newUDat = makeData(v, getDataOwners(uDat), false);
                     for (int i = 0; i < node_count; i++) {
                         if (isDataOwner(uDat, i)) {
@@ -81,8 +118,11 @@ public:
                         }
                     }
 
-                    mGlobalDataAccess.inc(1);
-                    to_union[u].store(v * 2 + 1, std::memory_order_release); // unlock
+                    (home == node ? mThisNodeWrite : mCrossNodeWrite).inc(1);
+                    uLock.store(v * 2 + 1, std::memory_order_release); // unlock
+                    Waiter::Notify(WaitPolicy_, uLock);
+                    if constexpr (Cohort)
+                        unlockCohort(u, node);
 
                     for (int i = 0; i < node_count; i++) { // TODO owners (keep them from prev step or read locally)
                         if (isDataOwner(uDat, i)) {
@@ -93,6 +133,8 @@ public:
 
                     break;
                 }
+                if constexpr (Cohort)
+                    unlockCohort(u, node);
             }
         }
     }
@@ -122,6 +164,21 @@ public:
     }
 
 private:
+    // returns false if the node-local lock was busy; then `u` has probably stopped being a root
+    bool lockCohort(int u, int node, Waiter& waiter) {
+        std::atomic<int>& word = cohort[node][u];
+        int expected = 0;
+        if (word.compare_exchange_strong(expected, 1, std::memory_order_acquire))
+            return true;
+        waiter.Wait(word, 1);
+        return false;
+    }
+
+    void unlockCohort(int u, int node) {
+        cohort[node][u].store(0, std::memory_order_release);
+        Waiter::Notify(WaitPolicy_, cohort[node][u]);
+    }
+
     int find(int u, int node, bool compressPaths) {
         if (compressPaths) {
             while (true) {
@@ -195,8 +252,10 @@ private:
         if (getDataFinalized(par)) {
             return par;
         } else {
-            mGlobalDataAccess.inc(1);
-            auto lock = to_union[u].load(std::memory_order_acquire);
+            // non-finalized data is written by the lock holder only, with the owners of the root
+            int home = getAnyDataOwnerId(par);
+            (home == NUMAContext::CurrentThreadNode() ? mThisNodeRead : mCrossNodeRead).inc(1);
+            auto lock = to_union[home][u].load(std::memory_order_acquire);
             if (getDataParent(par) == (lock >> 1)) {
                 if ((lock & 1) == 1) {
                     return par | M_FINALIZED;
@@ -215,8 +274,15 @@ private:
                 data[i][j].store(j | M_OWNERS | M_FINALIZED);
             }
         }
-        for (int i = 0; i < size; i++) {
-            to_union[i].store(i * 2 + 1);
+        for (int i = 0; i < node_count; i++) {
+            for (int j = 0; j < size; j++) {
+                to_union[i][j].store(j * 2 + 1);
+            }
+        }
+        for (auto* words : cohort) {
+            for (int j = 0; j < size; j++) {
+                words[j].store(0);
+            }
         }
     }
 
@@ -251,7 +317,8 @@ private:
     int size;
     int node_count;
     std::vector<std::atomic<int>*> data;
-    std::vector<std::atomic<int>> to_union;
+    std::vector<std::atomic<int>*> to_union; // per home node
+    std::vector<std::atomic<int>*> cohort;   // node-local lock words, with Cohort only
 
     static constexpr int MAX_NUMA_NODES = 4;
     static constexpr int MAX_VERTICES = (1 << (31 - MAX_NUMA_NODES)) - 1;
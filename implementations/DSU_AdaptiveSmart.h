@@ -8,11 +8,15 @@
 
 
 template <bool Halfing, bool AllowCrossNodeCompression=false>
-class DSU_AdaptiveSmart : public DSU {
+class DSU_AdaptiveSmart : public DSU, public OwnershipAware {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         using namespace std::string_literals;
-        return "AdaptiveSmart/"s + (Halfing ? "halfing" : "squashing");
+        return "AdaptiveSmart/"s + (AllowCrossNodeCompression ? "" : "local-compress/") + (Halfing ? "halfing" : "squashing");
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     DSU_AdaptiveSmart(NUMAContext* ctx, int size)
@@ -33,7 +37,11 @@ public:
         doReInit();
     }
 
-    void SetOwner(int v, int node) {
+    int Size() const override {
+        return size;
+    }
+
+    void SetOwner(int v, int node) override {
         for (int i = 0; i < node_count; i++) {
             int par = data[i][v].load(std::memory_order_relaxed);
             data[i][v].store(makeData(getDataParent(par), 1 << node, true), std::memory_order_relaxed);
@@ -47,6 +55,34 @@ public:
     }
 
     void DoUnion(int u, int v) override {
+        doUnion(u, v, false);
+    }
+
+    UnionResult DoTryUnion(int u, int v) override {
+        return doUnion(u, v, true);
+    }
+
+    // walks up from the larger vertex until the paths meet or it reaches a root, as Adaptive does
+    std::pair<int, int> FindPair(int u, int v) override {
+        int node = NUMAContext::CurrentThreadNode();
+        bool swapped = false;
+        while (u != v) {
+            if (v > u) {
+                std::swap(u, v);
+                swapped = !swapped;
+            }
+            int par = getDataParent(readDataChecked(node, u));
+            if (par == u)
+                break;
+            u = par;
+        }
+        int uRoot = getDataParent(find(u, node, true));
+        int vRoot = u == v ? uRoot : getDataParent(find(v, node, true));
+        return swapped ? std::make_pair(vRoot, uRoot) : std::make_pair(uRoot, vRoot);
+    }
+
+    // the root is looked up for unmerged sets only if `needRoot` is set
+    UnionResult doUnion(int u, int v, bool needRoot) {
         auto node = NUMAContext::CurrentThreadNode();
         // TODO try this optimization with node owners
 //        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
@@ -56,7 +92,7 @@ public:
         u = findLocalOnly(u, node, uDat);
         v = findLocalOnly(v, node, vDat);
         if (u == v)
-            return;
+            return {false, needRoot ? getDataParent(find(u, node, true)) : u};
         bool uRoot = isDataOwner(uDat, node);
         bool vRoot = isDataOwner(vDat, node);
         size_t it = 0;
@@ -68,7 +104,7 @@ public:
                 u = getDataParent(uDat);
                 v = getDataParent(vDat);
                 if (u == v)
-                    return;
+                    return {false, u};
                 uRoot = vRoot = true;
             }
             if (u < v) { // TODO try implicit pseudorandom priorities
@@ -89,7 +125,7 @@ public:
                 mCrossNodeWrite.inc(1);
             }
             if (data[owner][u].compare_exchange_strong(uDat, makeData(v, 1 << owner, true)))
-                break;
+                return {true, v};
 
             uRoot = false;
         }
@@ -1,179 +1,175 @@
-#ifndef TRY_DSU_FC_H
-#define TRY_DSU_FC_H
+#pragma once
+
+#include "DSU_Adaptive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+/*
+ * Per-node flat combining of unions over the Adaptive layout.
+ * A thread publishes its union in a slot of its node's publication array; one thread per node
+ * becomes the combiner, resolves all published pairs to roots with node-local walks first,
+ * drops the pairs whose sets are already united (also by the earlier pairs of the same batch)
+ * and links only the surviving roots, grouped by the node that owns the written root.
+ * SameSet and TryUnion go straight to the Adaptive implementation.
+ */
+template <bool Halfing>
+class DSU_FC : public DSU_Adaptive<Halfing, false> {
+    using Base = DSU_Adaptive<Halfing, false>;
 
-#include "../DSU.h"
-
-class DSU_FC: public DSU {
 public:
-    std::string ClassName() {
-        return "FC";
-    };
-
-    DSU_FC(int size, int node_count) :size(size), node_count(node_count) {
-        data.resize(node_count);
-        for (int i = 0; i < node_count; i++) {
-            data[i] = (std::atomic<int> *) numa_alloc_onnode(sizeof(std::atomic<int>) * size, i);
-            for (int j = 0; j < size; j++) {
-                data[i][j].store(j);
-            }
-        }
-
-        updates.resize(size*10);
-        for (int i = 0; i < size*10; i++) {
-            updates[i] = (std::atomic<long long>*) malloc(sizeof(std::atomic<long long>));
-            updates[i]->store(0);
-        }
-        last.store(0);
-        last_updated.resize(node_count);
-        for (int i = 0; i < node_count; i++) {
-            last_updated[i] = 0;
-        }
-
-        std::cerr << "fc: finished\n";
+    static std::string Name() {
+        using namespace std::string_literals;
+        return "FC/"s + (Halfing ? "halfing" : "squashing");
     }
 
-    void ReInit() override {
-        for (int i = 0; i < node_count; i++) {
-            for (int j = 0; j < size; j++) {
-                data[i][j].store(j);
-            }
-        }
+    std::string ClassName() override {
+        return Name();
+    };
 
-        for (int i = 0; i < size*10; i++) {
-            updates[i]->store(0);
+    DSU_FC(NUMAContext* ctx, int size)
+            : Base(ctx, size)
+            , slotIndex(ctx->MaxConcurrency())
+            , publications(ctx->NodeCount()) {
+        std::vector<int> slotCount(ctx->NodeCount(), 0);
+        for (int tid = 0; tid < (int) ctx->MaxConcurrency(); ++tid) {
+            slotIndex[tid] = slotCount[ctx->NumaNodeForThread(tid)]++;
         }
-        last.store(0);
-        for (int i = 0; i < node_count; i++) {
-            //upd_in_progress[i]->store(false);
-            last_updated[i] = 0;
+        for (int node = 0; node < (int) publications.size(); ++node) {
+            Publication& pub = publications[node];
+            pub.slotCount = std::max(slotCount[node], 1);
+            pub.combiner = new (ctx->Allocate(node, sizeof(Combiner))) Combiner();
+            pub.slots = (Slot*) ctx->Allocate(node, sizeof(Slot) * pub.slotCount);
+            for (int i = 0; i < pub.slotCount; ++i) {
+                new (&pub.slots[i]) Slot();
+            }
         }
     }
 
-    ~DSU_FC() {
-        for (int i = 0; i < node_count; i++) {
-            numa_free(data[i], sizeof(int) * size);
+    ~DSU_FC() override {
+        for (Publication& pub : publications) {
+            pub.combiner->~Combiner();
+            this->Ctx_->Free(pub.combiner, sizeof(Combiner));
+            this->Ctx_->Free(pub.slots, sizeof(Slot) * pub.slotCount);
         }
     }
 
-    bool DoSameSet(int u, int v) override {
-        auto node = NUMAContext::CurrentThreadNode();
-        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
-            return true;
-        }
-        auto u_p = u;
-        auto v_p = v;
-        while (true) {
-            u_p = do_find(node, u_p);
-            v_p = do_find(node, v_p);
-            if (u_p == v_p) {
-                return true;
-            }
-            if (data[node][u_p].load(std::memory_order_acquire) == u_p) {
-                return false;
+protected:
+    void DoUnion(int u, int v) override {
+        int tid = NUMAContext::CurrentThreadId();
+        int node = NUMAContext::CurrentThreadNode();
+        Publication& pub = publications[node];
+        Slot& slot = pub.slots[slotIndex[tid]];
+        slot.u = u;
+        slot.v = v;
+        slot.state.store(PENDING, std::memory_order_release);
+
+        // a combiner may miss the request published after its scan, so waiters never park
+        Waiter waiter(this->WaitPolicy_);
+        while (slot.state.load(std::memory_order_acquire) == PENDING) {
+            bool expected = false;
+            if (!pub.combiner->busy.load(std::memory_order_relaxed)
+                    && pub.combiner->busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                combine(pub);
+                pub.combiner->busy.store(false, std::memory_order_release);
+            } else {
+                waiter.Pause();
             }
         }
     }
 
-    int Find(int u) override {
-        int node = NUMAContext::CurrentThreadNode();
-        return do_find(node, u);
-    }
+private:
+    static constexpr int IDLE = 0;
+    static constexpr int PENDING = 1;
+
+    struct alignas(64) Slot {
+        std::atomic<int> state{IDLE};
+        int u = 0;
+        int v = 0;
+    };
 
-    void DoUnion(int u, int v) {
+    // a root to link below another one, and the node owning the written root
+    struct Link {
+        int owner;
+        int u;
+        int v;
+    };
+
+    struct alignas(64) Combiner {
+        std::atomic<bool> busy{false};
+        std::vector<int> batch;                     // slots taken by the current pass
+        std::unordered_map<int, int> batchSets;     // root -> parent within the batch
+        std::vector<Link> links;
+    };
+
+    struct Publication {
+        Combiner* combiner = nullptr;
+        Slot* slots = nullptr;
+        int slotCount = 0;
+    };
+
+    // called by the combiner of the node only
+    void combine(Publication& pub) {
+        Combiner& c = *pub.combiner;
         int node = NUMAContext::CurrentThreadNode();
-        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
-            return;
+        c.batch.clear();
+        c.batchSets.clear();
+        c.links.clear();
+        for (int i = 0; i < pub.slotCount; ++i) {
+            if (pub.slots[i].state.load(std::memory_order_acquire) == PENDING)
+                c.batch.push_back(i);
         }
-        long long to_union = ( ((long long) u) << 32) + v;
-
-        // add to queue
-        while (true) {
-            int the_last = last.load();
-            if (last.compare_exchange_weak(the_last, the_last + 1)) {
-                updates[the_last]->store(to_union);
-                break;
-            }
-            if (the_last >= size) {
-                std::cerr << "ALARM\n";
+
+        for (int i : c.batch) {
+            auto [u, v] = this->FindPair(pub.slots[i].u, pub.slots[i].v);
+            u = batchFind(c, u);
+            v = batchFind(c, v);
+            if (u == v) {
+                mFcDropped.inc(1);
+                continue;
             }
+            c.batchSets.emplace(u, v);
+            // linking by index hangs the larger root below the smaller one
+            int owner = Base::getAnyDataOwnerId(this->readDataChecked(node, std::max(u, v)));
+            c.links.push_back({owner, u, v});
         }
 
-        // try to start updating
-        if (upd_in_progress[node].try_lock()) {
-            do_all(node);
-            upd_in_progress[node].unlock();
+        // the writes to one node go together
+        std::stable_sort(c.links.begin(), c.links.end(), [](const Link& a, const Link& b) {
+            return a.owner < b.owner;
+        });
+        for (const Link& link : c.links) {
+            Base::DoUnion(link.u, link.v);
         }
 
-    }
-
-    int do_find(int node, int v) {
-        auto cur = v;
-        while (true) {
-            auto par = data[node][cur].load(std::memory_order_relaxed);
-            auto grand = data[node][par].load(std::memory_order_relaxed);
-            if (par == grand) {
-                return par;
-            } else {
-                data[node][cur].compare_exchange_weak(par, grand);
-            }
-            cur = par;
+        for (int i : c.batch) {
+            pub.slots[i].state.store(IDLE, std::memory_order_release);
         }
+        mFcBatches.inc(1);
+        mFcRequests.inc(c.batch.size());
     }
 
-    void do_all(int node) {
-        while (true) {
-            int the_last = last.load();
-            long long to_union;
-            long long u, v;
-            while (last_updated[node] < the_last) {
-                to_union = updates[last_updated[node]]->load();
-                while (to_union == 0) {
-                    to_union = updates[last_updated[node]]->load(std::memory_order_acquire);
-                }
-                last_updated[node]++;
-                u = to_union >> 32;
-                v = to_union - (u << 32);
-                do_union(node, u, v);
-            }
-            if (the_last == last.load()) {
-                break;
-            }
+    // representative of `u` among the roots linked earlier in the batch; compresses the chain it walks
+    static int batchFind(Combiner& c, int u) {
+        int root = u;
+        for (auto it = c.batchSets.find(root); it != c.batchSets.end(); it = c.batchSets.find(root)) {
+            root = it->second;
         }
-    }
-
-    void do_union(int node, int u, int v) {
-        int u_p = u;
-        int v_p = v;
-        while (true) {
-            u_p = do_find(node, u_p);
-            v_p = do_find(node, v_p);
-            if (u_p == v_p) {
-                return;
-            }
-            if (u_p < v_p) {
-                if (data[node][u_p].compare_exchange_weak(u_p, v_p)) {
-                    return;
-                }
-            } else {
-                if (data[node][v_p].compare_exchange_weak(v_p, u_p)) {
-                    return;
-                }
-            }
+        while (u != root) {
+            u = std::exchange(c.batchSets[u], root);
         }
+        return root;
     }
 
-    int size;
-    int node_count;
-    std::vector<std::atomic<int>*> data;
-
-    std::vector<std::atomic<long long>*> updates; // u + v
-    std::atomic<int> last; // in queue
-    bool FALSE = false;
-    bool TRUE = true;
-    int ZERO = 0;
-    //std::vector<std::atomic<bool>*> upd_in_progress; //on node
-    std::mutex upd_in_progress[4];
-    std::vector<int> last_updated; // on node
-};
+    std::vector<int> slotIndex; // thread id -> slot in the publication array of its node
+    std::vector<Publication> publications;
 
-#endif //TRY_DSU_FC_H
+    MetricsCollector::Accessor mFcBatches = this->accessor("fc_batches");
+    MetricsCollector::Accessor mFcRequests = this->accessor("fc_requests");
+    MetricsCollector::Accessor mFcDropped = this->accessor("fc_dropped");
+};
@@ -9,9 +9,13 @@
 template <bool Halfing>
 class DSU_LazyUnions : public DSU {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         using namespace std::string_literals;
         return "LazyUnions/"s + (Halfing ? "halfing" : "squashing");
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     DSU_LazyUnions(NUMAContext* ctx, int size)
@@ -33,6 +37,10 @@ public:
         doReInit();
     }
 
+    int Size() const override {
+        return size;
+    }
+
     ~DSU_LazyUnions() override {
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(int) * size);
@@ -40,6 +48,10 @@ public:
     }
 
     void DoUnion(int u, int v) override {
+        DoTryUnion(u, v);
+    }
+
+    UnionResult DoTryUnion(int u, int v) override {
         auto node = NUMAContext::CurrentThreadNode();
         // TODO try this optimization with node owners
 //        if (data[node][u].load(std::memory_order_relaxed) == data[node][v].load(std::memory_order_relaxed)) {
@@ -51,7 +63,7 @@ public:
             int vDat = find(v, node, true);
             v = getDataParent(vDat);
             if (u == v) {
-                return;
+                return {false, u};
             }
             if (u < v) { // TODO try implicit pseudorandom priorities
                 std::swap(u, v);
@@ -61,12 +73,14 @@ public:
             if ((uDat & M_OWNERS) != M_OWNERS) {
                 int uOwner = getAnyDataOwnerId(uDat);
                 (node == uOwner ? mThisNodeRead : mCrossNodeRead).inc(1);
-                while (getDataParent(data[uOwner][u].load()) == u)
-                    __builtin_ia32_pause();
+                Waiter waiter(WaitPolicy_);
+                int ownerDat;
+                while (getDataParent(ownerDat = data[uOwner][u].load()) == u)
+                    waiter.Wait(data[uOwner][u], ownerDat);
             }
 
             if (tryUpdateParent(u, v, node))
-                break;
+                return {true, v};
         }
     }
 
@@ -151,6 +165,7 @@ private:
         }
         mThisNodeWrite.inc(1);
         data[node][u].store(makeData(v, 1 << node, true));
+        Waiter::Notify(WaitPolicy_, data[node][u]);
         return true;
     }
 
@@ -8,9 +8,13 @@
 template <bool Halfing>
 class DSU_ParallelUnions : public DSU {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         using namespace std::string_literals;
         return "ParallelUnions/"s + (Halfing ? "halfing" : "squashing");
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     DSU_ParallelUnions(NUMAContext* ctx, int size)
@@ -40,6 +44,10 @@ public:
         }
     }
 
+    int Size() const override {
+        return size;
+    }
+
     ~DSU_ParallelUnions() {
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(int) * size);
@@ -83,6 +91,7 @@ public:
 
                 mGlobalDataAccess.inc(1);
                 to_union[u_p].store(v_p * 2 + 1, std::memory_order_release);
+                Waiter::Notify(WaitPolicy_, to_union[u_p]);
 
                 for (int i = 0; i < node_count; i++) {
                     auto par = v_p * 2;
@@ -90,10 +99,9 @@ public:
                 }
                 break;
             } else {
+                Waiter waiter(WaitPolicy_);
                 while (!(u_data & 1)) {
-#if defined(__x86_64__)
-                    __builtin_ia32_pause();
-#endif
+                    waiter.Wait(to_union[u_p], u_data);
                     u_data = to_union[u_p].load();
                 }
             }
@@ -152,7 +160,7 @@ public:
 private:
 
     int find(int u, int node, bool is_local, size_t& depth) {
-        if (is_local && DSU::EnableCompaction) {
+        if (is_local && CompactPaths()) {
             auto cur = u;
             while (true) {
                 ++depth;
@@ -45,6 +45,7 @@ public:
         auto node = NUMAContext::CurrentThreadNode();
         auto u_p = u;
         auto v_p = v;
+        Waiter waiter(WaitPolicy_);
         while (true) {
             u_p = find(u, node, true);
             v_p = find(v, node, true);
@@ -57,7 +58,7 @@ public:
             auto u_data = to_union[u_p].load(std::memory_order_acquire);
             if (u_data % 2 == 0) {
                 // union_(u_p, v_p, node, true);
-                // __builtin_ia32_pause()
+                waiter.Pause();
                 continue;
             } else {
                 if (to_union[u_p].compare_exchange_strong(u_data, v_p * 2)) {
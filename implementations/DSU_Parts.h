@@ -156,6 +156,7 @@ public:
         auto u_p = u;
         auto v_p = v;
         int res;
+        Waiter waiter(WaitPolicy_);
         while (true) {
             //std::cerr << "3";
             res = find(u_p, node, true);
@@ -188,7 +189,7 @@ public:
             auto u_data = to_union[u_p].load(std::memory_order_relaxed);
             if (!(u_data & status_bit)) {
                 // union_(u_p, v_p, node, true);
-                // __builtin_ia32_pause()
+                waiter.Pause();
                 continue;
             } else {
                 auto u_mask = u_data & node_full_mask;
@@ -1,50 +1,78 @@
+#pragma once
+
 #include "../DSU.h"
 
+#include <vector>
+
+/*
+ * Single-threaded baseline: plain int arrays, union by size and path halving, no atomics.
+ * Only one thread may use it at a time, BulkBuild included.
+ */
 class DSU_Sequential : public DSU {
 public:
-    DSU_Sequential(int size) {
-        this->size = size;
-        data.resize(size);
-        for (int i = 0; i < size; i++) {
-            data[i] = i;
-        }
+    static std::string Name() {
+        return "Sequential";
+    }
+
+    std::string ClassName() override {
+        return Name();
+    };
+
+    DSU_Sequential(int size)
+        : DSU_Sequential(nullptr, size) {}
+
+    DSU_Sequential(NUMAContext* ctx, int size)
+        : DSU(ctx)
+        , parent(size)
+        , setSize(size) {
+        ReInit();
     }
 
     void ReInit() override {
-        data.resize(size);
-        for (int i = 0; i < size; i++) {
-            data[i] = i;
+        for (int i = 0; i < (int) parent.size(); i++) {
+            parent[i] = i;
+            setSize[i] = 1;
         }
     }
 
+    int Size() const override {
+        return (int) parent.size();
+    }
+
     void DoUnion(int u, int v) override {
         int u_p = Find(u);
         int v_p = Find(v);
         if (u_p == v_p) {
             return;
         }
-        if (rand() % 2) {
-            data[u_p] = v_p;
-        } else {
-            data[v_p] = u_p;
+        if (setSize[u_p] < setSize[v_p]) {
+            std::swap(u_p, v_p);
         }
+        parent[v_p] = u_p;
+        setSize[u_p] += setSize[v_p];
     }
 
     int Find(int u) override {
-        int cur = u;
-        while (data[cur] != cur) {
-            auto par = data[cur];
-            data[cur] = data[par];
-            cur = par;
+        while (parent[u] != u) {
+            parent[u] = parent[parent[u]];
+            u = parent[u];
         }
-        return cur;
+        return u;
     }
 
     bool DoSameSet(int u, int v) override {
         return Find(u) == Find(v);
     }
 
+    // applied by the calling thread
+    void BulkBuild(std::span<const VertexPair> edges) override {
+        REQUIRE(!IsFrozen(), "BulkBuild of a frozen DSU; call Thaw() first");
+        for (const auto& edge : edges) {
+            DoUnion(edge.u, edge.v);
+        }
+    }
+
 private:
-    int size;
-    std::vector<int> data;
-};
\ No newline at end of file
+    std::vector<int> parent;
+    std::vector<int> setSize;
+};
@@ -1,12 +1,23 @@
+#pragma once
+
 #include "../DSU.h"
 
 class DSU_Usual : public DSU {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         return "Usual";
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
-    DSU_Usual(int size) :size(size) {
+    DSU_Usual(int size)
+        : DSU_Usual(nullptr, size) {}
+
+    DSU_Usual(NUMAContext* ctx, int size)
+        : DSU(ctx)
+        , size(size) {
         data1 = (std::atomic<int> *) numa_alloc_onnode(sizeof(std::atomic<int>) * (size / 2), 0);
         data2 = (std::atomic<int>*) numa_alloc_onnode(sizeof(std::atomic<int>) * (size - (size / 2)), 1);
         for (int i = 0; i < size / 2; i++) {
@@ -26,6 +37,10 @@ public:
         }
     }
 
+    int Size() const override {
+        return size;
+    }
+
     ~DSU_Usual() {
         numa_free(data1, sizeof(std::atomic<int>) * (size / 2));
         numa_free(data2, sizeof(std::atomic<int>) * (size - (size / 2)));
@@ -2,25 +2,44 @@
 
 #include "../DSU.h"
 #include "../lib/util.hpp"
-#include "../lib/nwire.hpp"
+#include "../lib/nbatch_wire.hpp"
+#include "../lib/linking.hpp"
 
 #include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <sstream>
 
 
-template <bool Halfing, bool Stepping, bool AllowCrossNodeCompression=false>
-class DSU_WireHelping : public DSU {
+/*
+ * With DedicatedServers every node gets a service thread that polls all channels targeted at the node
+ * while at least one thread works with the DSU; otherwise the channels are served by the worker threads
+ * of the node between their own operations. Linking chooses which root is hung below the other.
+ */
+template <bool Halfing, bool Stepping, bool AllowCrossNodeCompression=false, bool DedicatedServers=false,
+          LinkingPolicy Linking=LinkingPolicy::ByIndex>
+class DSU_WireHelping : public DSU, public OwnershipAware {
 public:
-    static_assert(!Stepping, "Stepping is not yet supported");
+    static std::string Name() {
+        using namespace std::string_literals;
+        std::string linking = Linking == LinkingPolicy::ByIndex ? ""s
+                : "link-"s + LinkingPolicyName(Linking) + "/"s;
+        return "WireHelping"s + (Stepping ? "3/" : "/") + (DedicatedServers ? "dedicated/" : "")
+            + (AllowCrossNodeCompression ? "" : "local-compress/") + linking + (Halfing ? "halfing" : "squashing");
+    }
 
     std::string ClassName() override {
-        using namespace std::string_literals;
-        return "WireHelping/"s + (Halfing ? "halfing" : "squashing");
+        return Name();
     };
 
     DSU_WireHelping(NUMAContext* ctx, int size)
-        : DSU(ctx)
-        , size(size), node_count(ctx->NodeCount()) {
+        : DSU(ctx, ctx->MaxConcurrency() + (DedicatedServers ? ctx->NodeCount() : 0))
+        , size(size), node_count(ctx->NodeCount())
+        , wire(ctx)
+        , registered(new std::atomic<bool>[ctx->MaxConcurrency()]) {
         using namespace std::string_literals;
         REQUIRE(size <= MAX_VERTICES, "Max supported size: "s + std::to_string(MAX_VERTICES)
                                              + "; given size "s + std::to_string(size));
@@ -29,49 +48,91 @@ public:
         for (int i = 0; i < node_count; i++) {
             data[i] = (std::atomic<int> *) Ctx_->Allocate(i, sizeof(std::atomic<int>) * size);
         }
-        doReInit();
 
-        std::vector<std::vector<int>> nodeTids(ctx->NodeCount(), std::vector<int>{});
-        for (size_t i = 0; i < ctx->MaxConcurrency(); ++i) {
-            nodeTids[ctx->NumaNodeForThread((int)i)].push_back((int)i);
-        }
-        std::vector<size_t> prevTid(ctx->NodeCount(), 0);
-        for (size_t i = 0; i < ctx->MaxConcurrency(); ++i) {
-            for (size_t node = 0; node < ctx->NodeCount(); ++node) {
-                if (ctx->NumaNodeForThread((int)i) == (int)node)
-                    wireLayout[node][i] = static_cast<int>(i);
-                else {
-                    wireLayout[node][i] = nodeTids[node][prevTid[node]++ % nodeTids[node].size()];
-                }
+        remoteClients.resize(node_count);
+        for (int node = 0; node < node_count; ++node) {
+            for (int client = 0; client < (int) ctx->MaxConcurrency(); ++client) {
+                if (ctx->NumaNodeForThread(client) != node)
+                    remoteClients[node].push_back(client);
             }
         }
+        doReInit();
     }
 
     void ReInit() override {
         doReInit();
     }
 
-    void SetOwner(int v, int node) {
+    int Size() const override {
+        return size;
+    }
+
+    void SetOwner(int v, int node) override {
         for (int i = 0; i < node_count; i++) {
             int par = data[i][v].load(std::memory_order_relaxed);
             data[i][v].store(makeData(getDataParent(par), 1 << node, true), std::memory_order_relaxed);
         }
     }
 
+    // the first thread of a node opens its channels; with DedicatedServers the first thread starts the servers
+    void Register() override {
+        int tid = NUMAContext::CurrentThreadId();
+        int node = NUMAContext::CurrentThreadNode();
+        std::lock_guard lock(membershipMutex);
+        if (registered[tid].load(std::memory_order_relaxed))
+            return;
+        if constexpr (DedicatedServers) {
+            registered[tid].store(true, std::memory_order_relaxed);
+            if (activeClients++ == 0)
+                startServers();
+            return;
+        }
+        bool wasClosed = routing.load(std::memory_order_relaxed)->servers[node].empty();
+        registered[tid].store(true, std::memory_order_relaxed);
+        publishRouting();
+        if (wasClosed)
+            wire.Reopen(node);
+    }
+
+    /*
+     * Channels of the leaving thread move to the other servers of its node.
+     * The last thread of a node closes its channels; remote clients read the node directly afterwards.
+     * With DedicatedServers the last thread stops the servers, so they do not poll between runs.
+     */
     void GoAway() override {
         int tid = NUMAContext::CurrentThreadId();
         int node = NUMAContext::CurrentThreadNode();
-        while (!wire.poison(tid))
-            satisfyWireRequests(tid, node);
+        std::lock_guard lock(membershipMutex);
+        if (!registered[tid].load(std::memory_order_relaxed))
+            return;
+        registered[tid].store(false, std::memory_order_relaxed);
+        if constexpr (DedicatedServers) {
+            if (--activeClients == 0)
+                stopServers();
+            return;
+        }
+        publishRouting();
+        if (routing.load(std::memory_order_relaxed)->servers[node].empty()) {
+            wire.Poison(node, WaitPolicy_, [this, node](const int* requests, int* responses, int count) {
+                serveFinds(node, requests, responses, count);
+            });
+        }
     }
 
     ~DSU_WireHelping() override {
+        stopServers();
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(int) * size);
         }
     }
 
 private:
+    // channels of remote clients are spread round-robin between the registered threads of the owner node
+    struct RoutingTable {
+        std::vector<std::vector<int>> servers;     // per node
+        std::vector<std::vector<int>> homeClients; // per thread: clients it serves on its node
+    };
+
     struct DepthStats {
         size_t local = 0;
         size_t crossNode = 0;
@@ -87,8 +148,43 @@ protected:
 
         DepthStats uStats, vStats;
 
-        DoUnionWithStats(u, v, uStats, vStats);
+        DoUnionWithStats(u, v, uStats, vStats, false);
+
+        incDepthHists(uStats, vStats);
+    }
 
+    UnionResult DoTryUnion(int u, int v) override {
+        satisfyWireRequests(NUMAContext::CurrentThreadId(), NUMAContext::CurrentThreadNode());
+
+        DepthStats uStats, vStats;
+
+        UnionResult r = DoUnionWithStats(u, v, uStats, vStats, true);
+
+        incDepthHists(uStats, vStats);
+        return r;
+    }
+
+    // walks up from the larger vertex until the paths meet or it reaches a root, as Adaptive does
+    std::pair<int, int> FindPair(int u, int v) override {
+        int node = NUMAContext::CurrentThreadNode();
+        size_t depth = 0; // unused
+        bool swapped = false;
+        while (u != v) {
+            if (v > u) {
+                std::swap(u, v);
+                swapped = !swapped;
+            }
+            int par = getDataParent(readDataChecked(node, u));
+            if (par == u)
+                break;
+            u = par;
+        }
+        int uRoot = getDataParent(find(u, node, CompactPaths(), depth));
+        int vRoot = u == v ? uRoot : getDataParent(find(v, node, CompactPaths(), depth));
+        return swapped ? std::make_pair(vRoot, uRoot) : std::make_pair(uRoot, vRoot);
+    }
+
+    void incDepthHists(const DepthStats& uStats, const DepthStats& vStats) {
         mHistLocalFindDepth.inc(uStats.local);
         mHistLocalFindDepth.inc(vStats.local);
         mHistCrossNodeFindDepth.inc(uStats.crossNode);
@@ -97,22 +193,23 @@ protected:
         mHistFindDepth.inc(vStats.total());
     }
 
-    void DoUnionWithStats(int u, int v, DepthStats& uStats, DepthStats& vStats) {
+    // the root is looked up for unmerged sets only if `needRoot` is set
+    UnionResult DoUnionWithStats(int u, int v, DepthStats& uStats, DepthStats& vStats, bool needRoot) {
         auto node = NUMAContext::CurrentThreadNode();
         int u_, v_; // unused
         u = findLocalOnly(u, node, u_, uStats.local);
         v = findLocalOnly(v, node, v_, vStats.local);
         if (u == v)
-            return;
+            return {false, needRoot ? getDataParent(find(u, node, CompactPaths(), uStats.crossNode)) : u};
         while (true) {
-            int uDat = find(u, node, EnableCompaction, uStats.crossNode);
+            int uDat = find(u, node, CompactPaths(), uStats.crossNode);
             u = getDataParent(uDat);
-            int vDat = find(v, node, EnableCompaction, vStats.crossNode);
+            int vDat = find(v, node, CompactPaths(), vStats.crossNode);
             v = getDataParent(vDat);
             if (u == v) {
-                return;
+                return {false, u};
             }
-            if (u < v) { // TODO try implicit pseudorandom priorities
+            if (LinksBelow<Linking>(v, u)) {
                 std::swap(u, v);
                 std::swap(uDat, vDat);
                 if (DSU::EnableMetrics) {
@@ -129,7 +226,7 @@ protected:
                 mCrossNodeWrite.inc(1);
             }
             if (data[owner][u].compare_exchange_strong(uDat, makeData(v, 1 << owner, true)))
-                break;
+                return {true, v};
         }
     }
 
@@ -161,14 +258,34 @@ protected:
         return r;
     }
 
+    /*
+     * A remote hop of the stepped pointer is delegated to the owner node while the other pointer
+     * advances over node-local data. The delegated find returns a root, which is not delegated again.
+     */
     bool DoSteppingSameSet(int u, int v, DepthStats& stats) { // TODO stats
         int node = NUMAContext::CurrentThreadNode();
+        int tid = NUMAContext::CurrentThreadId();
+        int resolved[2] = {-1, -1};
         bool freeze = false;
         while (true) {
             if (u == v)
                 return true;
-            if (!freeze && u > v)
+            if (!freeze && LinksBelow<Linking>(u, v))
                 std::swap(u, v);
+            if (u != resolved[0] && u != resolved[1]) {
+                mThisNodeRead.inc(1);
+                int uDat = readDataUnsafe(node, u);
+                int owner = getAnyDataOwnerId(uDat);
+                if (!isDataOwner(uDat, node) && postRequests(owner, tid, &u, 1)) {
+                    int vDat;
+                    v = findLocalOnly(v, node, vDat, stats.local);
+                    awaitResponses(owner, tid, node, &u, &u, 1, stats.crossNode);
+                    resolved[1] = resolved[0];
+                    resolved[0] = u;
+                    freeze = false;
+                    continue;
+                }
+            }
             int localDat;
             int parDat = readDataChecked(node, u, localDat);
             int par = getDataParent(parDat);
@@ -198,7 +315,7 @@ protected:
                     continue;
                 }
             } else {
-                if (!EnableCompaction) {
+                if (!CompactPaths()) {
                     if (!isDataOwner(localDat, node)) {
                         // copy non-root vertex to local memory
                         mThisNodeWrite.inc(1);
@@ -251,63 +368,179 @@ protected:
         }
 
         int tid = NUMAContext::CurrentThreadId();
-        int uWire = -1, vWire = -1;
+        int uOwner = isDataOwner(uDat, node) ? -1 : getAnyDataOwnerId(uDat);
+        int vOwner = isDataOwner(vDat, node) ? -1 : getAnyDataOwnerId(vDat);
+        bool uPosted = false, vPosted = false;
+
+        // both finds go in one batch if they are delegated to the same node
+        if (uOwner != -1 && uOwner == vOwner) {
+            int requests[2] = {u, v};
+            uPosted = vPosted = postRequests(uOwner, tid, requests, 2);
+        } else {
+            if (uOwner != -1)
+                uPosted = postRequests(uOwner, tid, &u, 1);
+            if (vOwner != -1)
+                vPosted = postRequests(vOwner, tid, &v, 1);
+        }
 
         // make one step up outside of loop to save local read
-        if (!isDataOwner(uDat, node)) {
-            uWire = tryPublishRequest(tid, getAnyDataOwnerId(uDat), u);
-            if (uWire == -1) {
-                mCrossNodeRead.inc(1);
-                uDat = readDataUnsafe(getAnyDataOwnerId(uDat), u);
-                u = getDataParent(uDat);
-                ++uStats.crossNode;
-            }
+        if (uOwner != -1 && !uPosted) {
+            mCrossNodeRead.inc(1);
+            uDat = readDataUnsafe(uOwner, u);
+            u = getDataParent(uDat);
+            ++uStats.crossNode;
         }
-        if (!isDataOwner(vDat, node)) {
-            vWire = tryPublishRequest(tid, getAnyDataOwnerId(vDat), v);
-            if (vWire == -1) {
-                mCrossNodeRead.inc(1);
-                vDat = readDataUnsafe(getAnyDataOwnerId(vDat), v);
-                v = getDataParent(vDat);
-                ++vStats.crossNode;
-            }
+        if (vOwner != -1 && !vPosted) {
+            mCrossNodeRead.inc(1);
+            vDat = readDataUnsafe(vOwner, v);
+            v = getDataParent(vDat);
+            ++vStats.crossNode;
         }
 
-        if (uWire == -1) {
-            uDat = find(u, node, EnableCompaction, uStats.crossNode);
+        if (!uPosted) {
+            uDat = find(u, node, CompactPaths(), uStats.crossNode);
             u = getDataParent(uDat);
         }
-        if (vWire == -1) {
-            vDat = find(v, node, EnableCompaction, vStats.crossNode);
+        if (!vPosted) {
+            vDat = find(v, node, CompactPaths(), vStats.crossNode);
             v = getDataParent(vDat);
         }
-        if (uWire != -1) {
-            u = wire.waitAndGet(uWire);
-        }
-        if (vWire != -1) {
-            v = wire.waitAndGet(vWire);
+        if (uPosted && uOwner == vOwner) {
+            int requests[2] = {u, v}, responses[2];
+            awaitResponses(uOwner, tid, node, requests, responses, 2, uStats.crossNode);
+            u = responses[0];
+            v = responses[1];
+        } else {
+            if (uPosted)
+                awaitResponses(uOwner, tid, node, &u, &u, 1, uStats.crossNode);
+            if (vPosted)
+                awaitResponses(vOwner, tid, node, &v, &v, 1, vStats.crossNode);
         }
 
-        bool firstIter = true;
-        while (true) {
-            if (u == v) {
-                return true;
+        return sameSetOfRoots(u, v, node, uStats, vStats, false);
+    }
+
+    /*
+     * Answers the queries in blocks of 64. The local parts of all paths are walked first,
+     * then the remaining finds are delegated to the owner nodes in batches of up to K requests
+     * with up to Wire::Batches batches in flight per owner node.
+     */
+    void DoBulkSameSet(std::span<const VertexPair> queries, uint64_t* result) override {
+        constexpr int BLOCK = 64;
+        int tid = NUMAContext::CurrentThreadId();
+        int node = NUMAContext::CurrentThreadNode();
+
+        std::array<int, 2 * BLOCK> roots;
+        std::vector<std::vector<int>> pending(node_count); // indices in `roots` to be resolved by the owner node
+        std::vector<size_t> posted(node_count), awaited(node_count);
+        std::vector<std::deque<int>> batchSizes(node_count);
+        int requests[Wire::Slots], responses[Wire::Slots];
+
+        for (size_t i = 0; i < queries.size(); i += BLOCK) {
+            satisfyWireRequests(tid, node);
+
+            int m = (int) std::min<size_t>(BLOCK, queries.size() - i);
+            uint64_t word = 0, decided = 0;
+            for (int j = 0; j < m; ++j) {
+                size_t depth = 0;
+                int uDat, vDat;
+                int u = findLocalOnly(queries[i + j].u, node, uDat, depth);
+                int v = findLocalOnly(queries[i + j].v, node, vDat, depth);
+                roots[2 * j] = u;
+                roots[2 * j + 1] = v;
+                if (u == v) {
+                    word |= uint64_t(1) << j;
+                    decided |= uint64_t(1) << j;
+                    continue;
+                }
+                bool uLocal = isDataOwner(uDat, node), vLocal = isDataOwner(vDat, node);
+                if (uLocal && vLocal) {
+                    mThisNodeRead.inc(1);
+                    if (getDataParent(readDataChecked(node, u)) == u) // still root?
+                        decided |= uint64_t(1) << j;
+                    continue;
+                }
+                if (!uLocal)
+                    pending[getAnyDataOwnerId(uDat)].push_back(2 * j);
+                if (!vLocal)
+                    pending[getAnyDataOwnerId(vDat)].push_back(2 * j + 1);
             }
-            if (!firstIter && getDataParent(readDataChecked(node, u)) == u) {
-                return false;
+
+            // ids[awaited..posted) of an owner are in flight, batchSizes holds their batches, oldest first
+            bool inFlight = true;
+            while (inFlight) {
+                inFlight = false;
+                for (int owner = 0; owner < node_count; ++owner) {
+                    auto& ids = pending[owner];
+                    while (posted[owner] < ids.size() && wire.InFlight(owner, tid) < Wire::Batches) {
+                        int count = (int) std::min<size_t>(Wire::Slots, ids.size() - posted[owner]);
+                        for (int k = 0; k < count; ++k)
+                            requests[k] = roots[ids[posted[owner] + k]];
+                        if (!postRequests(owner, tid, requests, count)) {
+                            // the owner has closed its channels
+                            for (size_t k = posted[owner]; k < ids.size(); ++k) {
+                                size_t depth = 0;
+                                roots[ids[k]] = getDataParent(find(roots[ids[k]], node, CompactPaths(), depth));
+                            }
+                            ids.resize(posted[owner]);
+                            break;
+                        }
+                        posted[owner] += count;
+                        batchSizes[owner].push_back(count);
+                    }
+                }
+                for (int owner = 0; owner < node_count; ++owner) {
+                    if (batchSizes[owner].empty())
+                        continue;
+                    inFlight = true;
+                    auto& ids = pending[owner];
+                    int count = batchSizes[owner].front();
+                    batchSizes[owner].pop_front();
+                    for (int k = 0; k < count; ++k)
+                        requests[k] = roots[ids[awaited[owner] + k]];
+                    size_t depth = 0;
+                    awaitResponses(owner, tid, node, requests, responses, count, depth);
+                    for (int k = 0; k < count; ++k)
+                        roots[ids[awaited[owner] + k]] = responses[k];
+                    awaited[owner] += count;
+                }
+            }
+            for (int owner = 0; owner < node_count; ++owner) {
+                pending[owner].clear();
+                posted[owner] = awaited[owner] = 0;
             }
-            uDat = find(u, node, EnableCompaction, uStats.crossNode);
-            vDat = find(v, node, EnableCompaction, vStats.crossNode);
-            firstIter = false;
+
+            for (int j = 0; j < m; ++j) {
+                if (decided >> j & 1)
+                    continue;
+                DepthStats uStats, vStats;
+                word |= uint64_t(sameSetOfRoots(roots[2 * j], roots[2 * j + 1], node, uStats, vStats, false)) << j;
+            }
+            result[i / 64] = word;
         }
     }
 
     int Find(int u) override {
         size_t depth = 0;
-        return getDataParent(find(u, NUMAContext::CurrentThreadNode(), EnableCompaction, depth));
+        return getDataParent(find(u, NUMAContext::CurrentThreadNode(), CompactPaths(), depth));
     }
 
 private:
+    // `u` and `v` are roots found earlier; if `checked` is not set they are looked up once more
+    bool sameSetOfRoots(int u, int v, int node, DepthStats& uStats, DepthStats& vStats, bool checked) {
+        while (true) {
+            if (u == v) {
+                return true;
+            }
+            if (checked && getDataParent(readDataChecked(node, u)) == u) {
+                return false;
+            }
+            u = getDataParent(find(u, node, CompactPaths(), uStats.crossNode));
+            v = getDataParent(find(v, node, CompactPaths(), vStats.crossNode));
+            checked = true;
+        }
+    }
+
     int findLocalOnly(int u, int node, int& localParDat, size_t& depth) { // returns vertex
         while (true) {
             ++depth;
@@ -320,7 +553,7 @@ private:
             }
             int par = getDataParent(parDat);
 
-            if (!DSU::EnableCompaction) {
+            if (!CompactPaths()) {
                 if (par == u) {
                     localParDat = parDat;
                     return u;
@@ -442,27 +675,139 @@ private:
                 data[i][j].store(makeData(j, 1, true));
             }
         }
+
+        // no operation runs concurrently, so retired routing tables can be freed;
+        // the servers are joined before the wire is reset
+        std::lock_guard lock(membershipMutex);
+        stopServers();
+        activeClients = 0;
+        for (int tid = 0; tid < (int) Ctx_->MaxConcurrency(); ++tid) {
+            registered[tid].store(false, std::memory_order_relaxed);
+        }
+        publishRouting();
+        retiredRoutings.clear();
+        wire.Reset();
+        if constexpr (!DedicatedServers) {
+            for (int node = 0; node < node_count; ++node) {
+                wire.Poison(node, WaitPolicy_, [](const int*, int*, int) {});
+            }
+        }
     }
 
-    int getWireIdForRequest(int tid, int node) {
-        return wireLayout[node][tid];
+    /*
+     * Builds the routing table for the current set of registered threads and publishes it RCU-style:
+     * servers may still walk the previous table, so it is retired until the next ReInit.
+     * Called with membershipMutex held.
+     */
+    void publishRouting() {
+        auto table = std::make_unique<RoutingTable>();
+        table->servers.resize(node_count);
+        table->homeClients.resize(Ctx_->MaxConcurrency());
+        for (int tid = 0; tid < (int) Ctx_->MaxConcurrency(); ++tid) {
+            if (registered[tid].load(std::memory_order_relaxed))
+                table->servers[Ctx_->NumaNodeForThread(tid)].push_back(tid);
+        }
+        for (int node = 0; node < node_count; ++node) {
+            const auto& servers = table->servers[node];
+            if (servers.empty())
+                continue;
+            for (size_t i = 0; i < remoteClients[node].size(); ++i) {
+                table->homeClients[servers[i % servers.size()]].push_back(remoteClients[node][i]);
+            }
+        }
+        routing.store(table.get(), std::memory_order_release);
+        if (currentRouting)
+            retiredRoutings.push_back(std::move(currentRouting));
+        currentRouting = std::move(table);
     }
 
-    int tryPublishRequest(int tid, int owner, int req) {
-        int w = getWireIdForRequest(tid, owner);
-        if (w <= tid) // TODO optimize
-            return -1;
-        if (wire.publishRequest(w, req))
-            return w;
-        return -1;
+    bool postRequests(int owner, int tid, const int* requests, int count) {
+        if (!wire.Post(owner, tid, requests, count))
+            return false;
+        mWireRoundTrips.inc(1);
+        mWireRequests.inc(count);
+        return true;
+    }
+
+    // waits for the roots of `requests`; the finds withdrawn from an unresponsive owner are done by the client
+    void awaitResponses(int owner, int tid, int node, const int* requests, int* responses, int count, size_t& depth) {
+        // the wait is bounded by the patience, so it never parks
+        Waiter waiter(WaitPolicy_);
+        bool served = wire.Await(owner, tid, responses, count, [this, node, &waiter]() {
+            if constexpr (!DedicatedServers)
+                serveNode(node);
+            waiter.Pause();
+        }, WIRE_PATIENCE);
+        if (served) {
+            depth += count;
+            return;
+        }
+        for (int k = 0; k < count; ++k) {
+            responses[k] = getDataParent(find(requests[k], node, CompactPaths(), depth));
+        }
+    }
+
+    void serveFinds(int node, const int* requests, int* responses, int count) {
+        for (int k = 0; k < count; ++k) {
+            __builtin_prefetch(&data[node][requests[k]]);
+        }
+        for (int k = 0; k < count; ++k) {
+            size_t depth = 0;
+            responses[k] = getDataParent(find(requests[k], node, CompactPaths(), depth));
+        }
     }
 
     void satisfyWireRequests(int tid, int node) {
-        int req;
-        if (wire.readRequest(tid, req)) {
-            size_t depth;
-            int res = find(req, node, EnableCompaction, depth);
-            wire.satisfyRequest(tid, getDataParent(res));
+        if (!registered[tid].load(std::memory_order_relaxed))
+            Register();
+        if constexpr (DedicatedServers)
+            return;
+        for (int client : routing.load(std::memory_order_acquire)->homeClients[tid]) {
+            wire.Serve(node, client, [this, node](const int* requests, int* responses, int count) {
+                serveFinds(node, requests, responses, count);
+            });
+        }
+    }
+
+    // serves all channels of the node; returns the number of served batches
+    int serveNode(int node) {
+        int served = 0;
+        for (int client : remoteClients[node]) {
+            served += wire.Serve(node, client, [this, node](const int* requests, int* responses, int count) {
+                serveFinds(node, requests, responses, count);
+            });
+        }
+        return served;
+    }
+
+    // called with membershipMutex held
+    void startServers() {
+        serverStop.store(false);
+        for (int node = 0; node < node_count; ++node) {
+            servers.push_back(Ctx_->StartServiceThread(node, [this, node]() {
+                serverLoop(node);
+            }));
+        }
+    }
+
+    // called with membershipMutex held or from the destructor; requests left unserved are withdrawn by their clients
+    void stopServers() {
+        serverStop.store(true);
+        for (auto& server : servers) {
+            server.join();
+        }
+        servers.clear();
+    }
+
+    // polls while there is work and waits as the wait policy says when there is none
+    void serverLoop(int node) {
+        Waiter waiter(WaitPolicy_);
+        while (!serverStop.load(std::memory_order_relaxed)) {
+            if (serveNode(node)) {
+                waiter = Waiter(WaitPolicy_);
+            } else {
+                waiter.Pause();
+            }
         }
     }
 
@@ -494,8 +839,10 @@ private:
         return data | ((1 << ownerId) << M_SHIFT_OWNERS);
     }
 
+    using Wire = NBatchWire<8>;
+
     static constexpr int MAX_NUMA_NODES = 4;
-    static constexpr int MAX_THREADS = 256;
+    static constexpr std::chrono::microseconds WIRE_PATIENCE{50};
     static constexpr int MAX_VERTICES = (1 << (31 - MAX_NUMA_NODES)) - 1;
     static constexpr int M_FINALIZED = 1 << 31;
     static constexpr int M_SHIFT_OWNERS = 31 - MAX_NUMA_NODES;
@@ -505,6 +852,17 @@ private:
     int size;
     int node_count;
     std::vector<std::atomic<int>*> data;
-    NWire<256> wire;
-    std::array<std::array<int, MAX_THREADS>, MAX_NUMA_NODES> wireLayout;
+    Wire wire;
+    std::vector<std::vector<int>> remoteClients;
+    std::unique_ptr<std::atomic<bool>[]> registered;
+    std::atomic<RoutingTable*> routing = nullptr;
+    std::unique_ptr<RoutingTable> currentRouting;
+    std::vector<std::unique_ptr<RoutingTable>> retiredRoutings;
+    std::mutex membershipMutex;
+    std::vector<std::thread> servers;
+    std::atomic<bool> serverStop = false;
+    int activeClients = 0; // registered threads, DedicatedServers only
+
+    MetricsCollector::Accessor mWireRequests = accessor("wire_requests");
+    MetricsCollector::Accessor mWireRoundTrips = accessor("wire_round_trips");
 };
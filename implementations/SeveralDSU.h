@@ -5,8 +5,12 @@
 
 class SeveralDSU : public DSU {
 public:
-    std::string ClassName() override {
+    static std::string Name() {
         return "SeveralDSU";
+    }
+
+    std::string ClassName() override {
+        return Name();
     };
 
     SeveralDSU(NUMAContext* ctx, int size)
@@ -29,6 +33,10 @@ public:
         }
     }
 
+    int Size() const override {
+        return size;
+    }
+
     ~SeveralDSU() override {
         for (int i = 0; i < node_count; i++) {
             Ctx_->Free(data[i], sizeof(std::atomic<int>) * (size / node_count + 1));
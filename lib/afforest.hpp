@@ -0,0 +1,182 @@
+#pragma once
+
+#include "numa.hpp"
+#include "node_partition.hpp"
+#include "vertex_pair.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+
+/*
+ * Offline parallel connected components (Afforest, Sutton et al., 2018): every vertex first links
+ * along a couple of sampled neighbours, then the largest intermediate component is detected by sampling
+ * and its vertices skip the rest of their edges, which are processed from the other side.
+ * Vertices are split between the worker threads by nodes (see NodePartition).
+ */
+class Afforest {
+public:
+    explicit Afforest(NUMAContext* ctx)
+            : Ctx_(ctx) {}
+
+    /*
+     * `seed(u)` gives the initial parent of u; it must form a forest with parent <= child.
+     * `emit(u, root)` receives the minimal vertex of the component of u.
+     * Both are called once per vertex from the worker threads.
+     * Must not be called from a worker thread of the same context.
+     */
+    template <class Seed, class Emit>
+    void Run(int size, std::span<const VertexPair> edges, Seed&& seed, Emit&& emit) {
+        if (size == 0)
+            return;
+
+        int numThreads = (int) Ctx_->MaxConcurrency();
+        NodePartition partition(Ctx_, numThreads, size);
+
+        std::vector<int> comp(size);
+        std::vector<int> offsets(size + 1, 0); // degrees at first
+        std::vector<int> cursors(size);
+        std::vector<int> chunkDegrees(numThreads, 0);
+        std::vector<int> adjacency;
+        int largest = -1;
+        std::barrier barrier(numThreads);
+
+        Ctx_->StartNThreads([&]() {
+            int tid = NUMAContext::CurrentThreadId();
+            auto [begin, end] = partition.Chunk(tid);
+            auto [edgeBegin, edgeEnd] = NodePartition::Split(0, (int) edges.size(), tid, numThreads);
+
+            for (int u = begin; u < end; ++u) {
+                comp[u] = seed(u);
+            }
+            for (int i = edgeBegin; i < edgeEnd; ++i) {
+                auto [u, v] = edges[i];
+                if (u == v)
+                    continue;
+                std::atomic_ref(offsets[u]).fetch_add(1, std::memory_order_relaxed);
+                std::atomic_ref(offsets[v]).fetch_add(1, std::memory_order_relaxed);
+            }
+            barrier.arrive_and_wait();
+
+            // CSR offsets: prefix sums of chunks, then chunks with a smaller begin are added
+            int degrees = 0;
+            for (int u = begin; u < end; ++u) {
+                degrees += offsets[u];
+            }
+            chunkDegrees[tid] = degrees;
+            barrier.arrive_and_wait();
+
+            int offset = 0;
+            for (int oth = 0; oth < numThreads; ++oth) {
+                if (partition.Chunk(oth).first < begin)
+                    offset += chunkDegrees[oth];
+            }
+            for (int u = begin; u < end; ++u) {
+                int degree = offsets[u];
+                offsets[u] = cursors[u] = offset;
+                offset += degree;
+            }
+            if (begin < end && end == size)
+                offsets[size] = offset;
+            barrier.arrive_and_wait();
+            if (tid == 0)
+                adjacency.resize(offsets[size]);
+            barrier.arrive_and_wait();
+
+            for (int i = edgeBegin; i < edgeEnd; ++i) {
+                auto [u, v] = edges[i];
+                if (u == v)
+                    continue;
+                adjacency[std::atomic_ref(cursors[u]).fetch_add(1, std::memory_order_relaxed)] = v;
+                adjacency[std::atomic_ref(cursors[v]).fetch_add(1, std::memory_order_relaxed)] = u;
+            }
+            barrier.arrive_and_wait();
+
+            for (int round = 0; round < NEIGHBOUR_ROUNDS; ++round) {
+                for (int u = begin; u < end; ++u) {
+                    if (offsets[u] + round < offsets[u + 1])
+                        link(comp.data(), u, adjacency[offsets[u] + round]);
+                }
+                barrier.arrive_and_wait();
+                compress(comp.data(), begin, end);
+                barrier.arrive_and_wait();
+            }
+
+            if (tid == 0)
+                largest = sampleLargest(comp.data(), size);
+            barrier.arrive_and_wait();
+
+            for (int u = begin; u < end; ++u) {
+                if (load(comp[u]) == largest)
+                    continue;
+                for (int i = offsets[u] + NEIGHBOUR_ROUNDS; i < offsets[u + 1]; ++i) {
+                    link(comp.data(), u, adjacency[i]);
+                }
+            }
+            barrier.arrive_and_wait();
+            compress(comp.data(), begin, end);
+            barrier.arrive_and_wait();
+
+            for (int u = begin; u < end; ++u) {
+                emit(u, comp[u]);
+            }
+        }, numThreads);
+        Ctx_->Join();
+    }
+
+private:
+    static int load(int& x) {
+        return std::atomic_ref(x).load(std::memory_order_relaxed);
+    }
+
+    // hooks the larger of two roots under the smaller one
+    static void link(int* comp, int u, int v) {
+        int p1 = load(comp[u]);
+        int p2 = load(comp[v]);
+        while (p1 != p2) {
+            int high = std::max(p1, p2);
+            int low = std::min(p1, p2);
+            int highPar = load(comp[high]);
+            if (highPar == low)
+                break;
+            if (highPar == high && std::atomic_ref(comp[high]).compare_exchange_strong(highPar, low))
+                break;
+            p1 = load(comp[load(comp[high])]);
+            p2 = load(comp[low]);
+        }
+    }
+
+    static void compress(int* comp, int begin, int end) {
+        for (int u = begin; u < end; ++u) {
+            while (true) {
+                int par = load(comp[u]);
+                int grand = load(comp[par]);
+                if (par == grand)
+                    break;
+                std::atomic_ref(comp[u]).store(grand, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static int sampleLargest(int* comp, int size) {
+        std::unordered_map<int, int> counts;
+        std::uniform_int_distribution<int> distribution(0, size - 1);
+        for (int i = 0; i < NUM_SAMPLES; ++i) {
+            ++counts[load(comp[distribution(TlRandom)])];
+        }
+        return std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.second < b.second;
+        })->first;
+    }
+
+    static constexpr int NEIGHBOUR_ROUNDS = 2;
+    static constexpr int NUM_SAMPLES = 1024;
+
+    NUMAContext* Ctx_;
+};
@@ -4,31 +4,40 @@
 #include "numa.hpp"
 #include "util.hpp"
 #include "stats.hpp"
+#include "timer.hpp"
+#include "latency.hpp"
+#include "request_router.hpp"
+#include "devirtualized.hpp"
+#include "timeline.hpp"
+#include "metric_series.hpp"
 #include "../DSU.h"
 
 #include <barrier>
+#include <chrono>
 #include <span>
 #include <string_view>
 #include <array>
 #include <map>
+#include <memory>
+#include <limits>
+#include <random>
+#include <thread>
 
 
 /*
- * For each vertex find a node which most frequently accesses the vertex and sets it as an owner of the vertex.
+ * Resets the DSU. For each vertex find a node which most frequently accesses the vertex and,
+ * if the DSU is OwnershipAware, sets it as an owner of the vertex.
  */
-template <class DSUType>
-void PrepareDSUForWorkload(DSU* someDsu, const StaticWorkload& workload) {
-    DSUType* dsu = dynamic_cast<DSUType*>(someDsu);
+inline void PrepareDSUForWorkload(DSU* someDsu, const StaticWorkload& workload) {
+    someDsu->Thaw();
+    someDsu->ReInit();
+    auto* dsu = dynamic_cast<OwnershipAware*>(someDsu);
     if (!dsu)
         return;
 
-    const int* cMapping = workload.GetMeta<ComponentMappingMd>().Mapping.data();
-
     // Fast setup
-    for (int u = 0; u < (int)workload.N; ++u) {
-        int expId = cMapping[u];
-        dsu->SetOwner(u, expId);
-    }
+    const auto& cMapping = workload.GetMeta<ComponentMappingMd>().Mapping;
+    dsu->SetOwners(std::span(cMapping.data(), workload.N));
 
     // Precise setup (slow)
 //    std::unordered_map<int, std::vector<uint32_t>> stats;
@@ -64,46 +73,269 @@ void PrepareDSUForWorkload(DSU* someDsu, const StaticWorkload& workload) {
 }
 
 class Benchmark {
+    using Clock = std::chrono::steady_clock;
+
 public:
+    // requests between two points of a ThreadTimeline, and between two checks of the stop flag in the closed loop
+    static constexpr size_t TIMELINE_CHUNK = 1 << 14;
+    // the longest time between two points of a ThreadTimeline in the open loop
+    static constexpr std::chrono::milliseconds TIMELINE_PERIOD{10};
+
     Benchmark(NUMAContext* ctx)
             : Ctx_(ctx)
     {}
 
     void Run(DSU* dsu, const StaticWorkload& workload, bool ignoreMeasurements = false) {
         size_t numThreads = workload.ThreadRequests.size();
-        std::barrier barrier(numThreads);
-        ApplyRequests(dsu, workload.PreHeatRequests, false);
+        bool timed = Duration_.count() > 0;
+        REQUIRE(!timed || !Routing_, "Fixed-duration runs do not support routing");
+        REQUIRE(ArrivalRate_ <= 0 || !Routing_, "Open-loop runs do not support routing");
+        std::atomic<bool> started = false;
+        std::atomic<bool> stop = false;
+        Clock::time_point runStart;
+        std::barrier barrier(numThreads, [&runStart, &started]() noexcept {
+            runStart = Clock::now();
+            started.store(true);
+            started.notify_all();
+        });
+        Preheat(dsu, workload.PreHeatRequests);
         size_t resultsOffset = ThroughputResults_[dsu].size();
         if (!ignoreMeasurements)
             ThroughputResults_[dsu].resize(resultsOffset + numThreads, 0.0);
 
         dsu->resetMetrics();
 
+        std::unique_ptr<RequestRouter> router;
+        if (Routing_) {
+            const auto& owners = workload.GetMeta<ComponentMappingMd>().Mapping;
+            router = std::make_unique<RequestRouter>(Ctx_, (int) numThreads, owners.data());
+        }
+        std::vector<LatencyRecorder> latencies(numThreads);
+        std::vector<ThreadTimeline> timelines(numThreads);
+
         Ctx_->StartNThreads(
-                [this, &barrier, &workload, dsu, resultsOffset, ignoreMeasurements]() {
+                [this, &barrier, &workload, &router, &latencies, &timelines, &stop, &runStart, timed, dsu,
+                 resultsOffset, ignoreMeasurements]() {
+                    int tid = NUMAContext::CurrentThreadId();
+                    // built by the worker itself to keep the columns node-local
+                    std::unique_ptr<RequestColumns> columns;
+                    if (Layout_ == RequestLayout::SoA && !router)
+                        columns = std::make_unique<RequestColumns>(workload.ThreadRequests[tid]);
                     barrier.arrive_and_wait();
-                    double avgThrpt = ThreadWork(dsu, workload.ThreadRequests[NUMAContext::CurrentThreadId()]);
+                    timelines[tid].Thread = tid;
+                    timelines[tid].Node = NUMAContext::CurrentThreadNode();
+                    double avgThrpt = ThreadWork(dsu, workload.ThreadRequests[tid], columns.get(), router.get(),
+                                                 timed ? &stop : nullptr, runStart, latencies[tid], timelines[tid]);
                     if (!ignoreMeasurements)
-                        ThroughputResults_[dsu][resultsOffset + NUMAContext::CurrentThreadId()] = avgThrpt;
+                        ThroughputResults_[dsu][resultsOffset + tid] = avgThrpt;
                 },
                 numThreads
         );
+        std::atomic<bool> finished = false;
+        std::vector<MetricSample> samples;
+        std::thread sampler;
+        if (SamplingPeriod_.count() > 0 && !ignoreMeasurements) {
+            sampler = std::thread([this, &started, &finished, &runStart, &samples, dsu]() {
+                started.wait(false);
+                for (auto next = runStart; !finished.load(std::memory_order_relaxed); next += SamplingPeriod_) {
+                    std::this_thread::sleep_until(next);
+                    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - runStart);
+                    samples.push_back({time.count(), dsu->collectMetrics(), dsu->collectHistMetrics()});
+                }
+            });
+        }
+        if (timed) {
+            started.wait(false);
+            std::this_thread::sleep_until(runStart + Duration_);
+            stop.store(true, std::memory_order_release);
+        }
         Ctx_->Join();
+        if (sampler.joinable()) {
+            finished.store(true, std::memory_order_relaxed);
+            sampler.join();
+        }
         if (!ignoreMeasurements) {
+            if (SamplingPeriod_.count() > 0)
+                Samples_[dsu].push_back(std::move(samples));
             Metrics_[dsu].emplace_back(dsu->collectMetrics());
             if (DSU::EnableMetrics)
                 ProduceSecondaryMetrics(Metrics_[dsu].back());
             HistMetrics_[dsu].emplace_back(dsu->collectHistMetrics());
+            if (ArrivalRate_ > 0) {
+                Metrics_[dsu].back()["offered_load"] = ArrivalRate_ * numThreads;
+                HistMetrics_[dsu].back()["response_time_log2_ns"] = ResponseTimeHistogram(latencies);
+            }
+            ProduceLatencyMetrics(Metrics_[dsu].back(), latencies);
+            ProduceCompletionMetrics(Metrics_[dsu].back(), timelines);
+            Timelines_[dsu].push_back(std::move(timelines));
+            if (router) {
+                Metrics_[dsu].back()["routed_fraction"] = (double) router->RoutedRequests() / TotalRequests(workload);
+                Metrics_[dsu].back()["cross_node_fraction"] = (double) router->CrossNodeRequests() / TotalRequests(workload);
+            }
+        }
+    }
+
+    /*
+     * Applies the requests of all threads, one stream after another, on worker thread 0 alone;
+     * the single result is the total throughput. For single-threaded DSUs (see DSU_Sequential).
+     * Follows the request layout; closed-loop only, so neither a duration nor an arrival rate may be set.
+     */
+    void RunSequential(DSU* dsu, const StaticWorkload& workload, bool ignoreMeasurements = false) {
+        constexpr size_t NS = 1'000'000'000ull;
+        REQUIRE(Duration_.count() == 0 && ArrivalRate_ <= 0, "The sequential baseline is closed-loop only");
+        Preheat(dsu, workload.PreHeatRequests);
+        Ctx_->StartThread([this, &workload, dsu, ignoreMeasurements]() {
+            LatencyRecorder latencies;
+            std::vector<RequestColumns> columns;
+            if (Layout_ == RequestLayout::SoA) {
+                for (const auto& requests : workload.ThreadRequests) {
+                    columns.emplace_back(requests);
+                }
+            }
+            Timer timer;
+            if (Layout_ == RequestLayout::SoA) {
+                for (const auto& threadColumns : columns) {
+                    ApplyRequests(dsu, threadColumns.All(), true, latencies);
+                }
+            } else {
+                for (const auto& requests : workload.ThreadRequests) {
+                    ApplyRequests(dsu, std::span<const Request>(requests), true, latencies);
+                }
+            }
+            auto duration = timer.Get<std::chrono::nanoseconds>();
+            if (!ignoreMeasurements)
+                ThroughputResults_[dsu].push_back(TotalRequests(workload) * NS / std::max<long>(duration.count(), 1));
+        });
+        Ctx_->Join();
+    }
+
+    /*
+     * If set, requests are dispatched to the nodes owning their vertices (see RequestRouter)
+     * instead of being applied by the thread that issued them.
+     */
+    void SetRouting(bool routing) {
+        Routing_ = routing;
+    }
+
+    // the routed run always reads the Request array
+    void SetRequestLayout(RequestLayout layout) {
+        Layout_ = layout;
+    }
+
+    /*
+     * If positive, the threads of Run cycle through their requests until the calling thread raises
+     * the shared stop flag after the duration, instead of applying each request once. Not supported with routing.
+     */
+    void SetDuration(std::chrono::milliseconds duration) {
+        Duration_ = duration;
+    }
+
+    /*
+     * If positive, a sampler thread snapshots the counters and histograms of the DSU with this period
+     * during every measured run of Run (see CollectSamples). Workers are not stopped; the counters exist with
+     * DSU::EnableMetrics only.
+     */
+    void SetSamplingPeriod(std::chrono::milliseconds period) {
+        SamplingPeriod_ = period;
+    }
+
+    /*
+     * Builds the sets of the preheat by DSU::BulkBuild (e.g. offline for the Adaptive family) instead of
+     * applying its requests one by one. The measured runs may then start from other trees and replicas.
+     */
+    void SetBulkPreheat(bool bulkPreheat) {
+        BulkPreheat_ = bulkPreheat;
+    }
+
+    /*
+     * Times every RequestRouter::LATENCY_SAMPLE_PERIOD-th request of the closed loop. Off by default, since
+     * the timed requests split the request loop; open-loop and routed runs always record latencies.
+     */
+    void SetLatencySampling(bool sampleLatencies) {
+        SampleLatencies_ = sampleLatencies;
+    }
+
+    // mean of RandomAdditionalWork after every request of the closed loop
+    void SetAdditionalWork(double additionalWork) {
+        AdditionalWork_ = additionalWork;
+    }
+
+    /*
+     * If positive, Run is open-loop: the requests of every thread arrive as a Poisson process
+     * of this rate (per second) instead of back to back (see ApplyOpenLoop). Not supported with routing.
+     */
+    void SetArrivalRate(double requestsPerSecond) {
+        ArrivalRate_ = requestsPerSecond;
+    }
+
+    /*
+     * Measures bulk SameSet throughput: every request of a thread, whatever its type, is used as a query.
+     * The DSU answers from its frozen labels if it is frozen and by DoBulkSameSet otherwise.
+     * The metrics of the run (DSU::EnableMetrics) get the number of queries and, for the wire, round trips per query.
+     */
+    void RunBulkSameSet(DSU* dsu, const StaticWorkload& workload, GatherKernel kernel, bool ignoreMeasurements = false) {
+        size_t numThreads = workload.ThreadRequests.size();
+        std::barrier barrier(numThreads);
+        size_t resultsOffset = ThroughputResults_[dsu].size();
+        if (!ignoreMeasurements)
+            ThroughputResults_[dsu].resize(resultsOffset + numThreads, 0.0);
+        dsu->resetMetrics();
+
+        Ctx_->StartNThreads(
+                [this, &barrier, &workload, dsu, kernel, resultsOffset, ignoreMeasurements]() {
+                    constexpr size_t NS = 1'000'000'000ull;
+                    int tid = NUMAContext::CurrentThreadId();
+                    // built by the worker itself to keep the queries node-local
+                    const auto& requests = workload.ThreadRequests[tid];
+                    std::vector<VertexPair> queries(requests.size());
+                    std::transform(requests.begin(), requests.end(), queries.begin(), [](const Request& r) {
+                        return VertexPair{r.U(), r.V()};
+                    });
+                    std::vector<uint64_t> result((queries.size() + 63) / 64);
+
+                    barrier.arrive_and_wait();
+                    Timer timer;
+                    dsu->BulkSameSet(queries, result.data(), kernel);
+                    auto duration = timer.Get<std::chrono::nanoseconds>();
+                    dsu->GoAway();
+                    Blackhole(reinterpret_cast<int*>(result.data()));
+                    if (!ignoreMeasurements)
+                        ThroughputResults_[dsu][resultsOffset + tid] = queries.size() * NS / std::max<long>(duration.count(), 1);
+                },
+                numThreads
+        );
+        Ctx_->Join();
+        if (!ignoreMeasurements && DSU::EnableMetrics) {
+            Metrics& metrics = Metrics_[dsu].emplace_back(dsu->collectMetrics());
+            metrics["bulk_queries"] = (double) TotalRequests(workload);
+            if (metrics.data().contains("wire_round_trips"))
+                metrics["wire_round_trips_per_op"] = metrics["wire_round_trips"] / metrics["bulk_queries"];
         }
     }
 
-    double ThreadWork(DSU* dsu, std::span<const Request> requests) {
+    /*
+     * `columns` is the SoA copy of `requests` or null. Without `stop` every request is applied once,
+     * otherwise the requests are cycled through until it is raised. Returns the throughput of the thread.
+     */
+    double ThreadWork(DSU* dsu, std::span<const Request> requests, const RequestColumns* columns,
+                      RequestRouter* router, const std::atomic<bool>* stop, Clock::time_point runStart,
+                      LatencyRecorder& latencies, ThreadTimeline& timeline) {
         constexpr size_t NS = 1'000'000'000ull;
-        Timer timer;
-        ApplyRequests(dsu, requests, true);
-        auto duration = timer.Get<std::chrono::nanoseconds>();
+        auto sinceStart = [runStart]() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - runStart).count();
+        };
+        timeline.Progress.push_back({0, sinceStart()});
+        if (router) {
+            auto duration = router->Run(dsu, requests, [this]() { RandomAdditionalWork(AdditionalWork_); }, latencies);
+            timeline.Progress.push_back({requests.size(), timeline.Progress[0].second + duration.count()});
+        } else if (columns) {
+            ApplyChunks(dsu, columns->All(), stop, latencies, timeline, sinceStart);
+        } else {
+            ApplyChunks(dsu, requests, stop, latencies, timeline, sinceStart);
+        }
         dsu->GoAway();
-        return requests.size() * NS / duration.count();
+        auto [done, finish] = timeline.Progress.back();
+        return done * NS / std::max<int64_t>(finish - timeline.Progress[0].second, 1);
     }
 
     Stats<double> CollectThroughputStats(DSU* dsu) {
@@ -130,13 +362,200 @@ public:
         return std::exchange(HistMetrics_[dsu], {});
     }
 
+    // thread timelines of every measured run
+    std::vector<std::vector<ThreadTimeline>> CollectTimelines(DSU* dsu) {
+        return std::exchange(Timelines_[dsu], {});
+    }
+
+    // metric time series of every measured run, if sampling is on
+    std::vector<std::vector<MetricSample>> CollectSamples(DSU* dsu) {
+        return std::exchange(Samples_[dsu], {});
+    }
+
 private:
-    void ApplyRequests(DSU* dsu, std::span<const Request> requests, bool useAdditionalWork) const {
+    /*
+     * The preheat requests are applied by the calling thread, unless bulk preheat is on: then their unions
+     * go to BulkBuild and the SameSet requests are dropped. Either way the preheat is not measured.
+     */
+    void Preheat(DSU* dsu, std::span<const Request> requests) const {
+        if (!BulkPreheat_) {
+            LatencyRecorder ignored;
+            ApplyRequests(dsu, requests, false, ignored);
+            return;
+        }
+        std::vector<VertexPair> edges;
         for (const auto& request : requests) {
-            request.Apply(dsu);
-            if (useAdditionalWork)
-                RandomAdditionalWork(AdditionalWork_);
+            if (!request.IsSameSet())
+                edges.push_back({request.U(), request.V()});
+        }
+        if (!edges.empty())
+            dsu->BulkBuild(edges);
+    }
+
+    /*
+     * With latency sampling, latencies of every RequestRouter::LATENCY_SAMPLE_PERIOD-th request are recorded
+     * in `latencies` (ns) and a RequestRunner gets the requests in between as spans; without it the runner
+     * gets all the requests as one span.
+     */
+    template <class Requests>
+    void ApplyRequests(DSU* dsu, const Requests& requests, bool useAdditionalWork,
+                       LatencyRecorder& latencies) const {
+        constexpr size_t PERIOD = RequestRouter::LATENCY_SAMPLE_PERIOD;
+        double additionalWork = useAdditionalWork ? AdditionalWork_ : 0.0;
+        auto* runner = dynamic_cast<RequestRunner*>(dsu);
+        if (!SampleLatencies_) {
+            ApplySpan(dsu, runner, requests, additionalWork);
+            return;
+        }
+        for (size_t i = 0; i < requests.size(); i += PERIOD) {
+            Timer timer;
+            ApplySpan(dsu, runner, requests.subspan(i, 1), 0.0);
+            latencies.Add((uint32_t) timer.Get<std::chrono::nanoseconds>().count());
+            RandomAdditionalWork(additionalWork);
+            ApplySpan(dsu, runner, requests.subspan(i + 1, std::min(PERIOD, requests.size() - i) - 1), additionalWork);
+        }
+    }
+
+    // a RequestRunner (see Devirtualized) applies the span by one virtual call
+    template <class Requests>
+    static void ApplySpan(DSU* dsu, RequestRunner* runner, const Requests& requests, double additionalWork) {
+        if (runner) {
+            runner->ApplyRequests(requests, additionalWork);
+        } else {
+            ApplyRequestsVirtual(dsu, requests, additionalWork);
+        }
+    }
+
+    /*
+     * Applies the requests by TIMELINE_CHUNK, appending a point to the timeline after every chunk
+     * and a final one after the last request (or after the stop flag is seen).
+     * An open-loop chunk also ends after TIMELINE_PERIOD, and the stop flag is checked before every request.
+     */
+    template <class Requests>
+    void ApplyChunks(DSU* dsu, const Requests& requests, const std::atomic<bool>* stop,
+                     LatencyRecorder& latencies, ThreadTimeline& timeline, auto sinceStart) const {
+        size_t done = 0;
+        double due = (double) timeline.Progress[0].second;
+        if (ArrivalRate_ > 0)
+            due += std::exponential_distribution<double>(ArrivalRate_ / 1e9)(TlRandom);
+        for (size_t i = 0; i < requests.size();) {
+            auto chunk = requests.subspan(i, std::min(TIMELINE_CHUNK, requests.size() - i));
+            size_t applied = chunk.size();
+            if (ArrivalRate_ > 0) {
+                int64_t deadline = sinceStart() + std::chrono::nanoseconds(TIMELINE_PERIOD).count();
+                applied = ApplyOpenLoop(dsu, chunk, due, latencies, stop, deadline, sinceStart);
+            } else {
+                ApplyRequests(dsu, chunk, true, latencies);
+            }
+            done += applied;
+            i += applied;
+            if (stop && stop->load(std::memory_order_acquire))
+                break;
+            if (i == requests.size()) {
+                if (!stop)
+                    break;
+                i = 0;
+            }
+            timeline.Progress.push_back({done, sinceStart()});
+        }
+        // read after the stop flag, so a timed run finishes no earlier than its duration
+        timeline.Progress.push_back({done, sinceStart()});
+    }
+
+    /*
+     * Open loop: a request is due at its arrival (ns since the start of the run; the arrivals are
+     * a Poisson process of ArrivalRate_) and is issued as soon as both it is due and the previous one is answered.
+     * Its response time is measured from the arrival, so a stall delays the answers to all requests arriving
+     * meanwhile instead of being omitted. Response times of all requests go to `latencies`.
+     * `due` is the arrival of the first request. Returns the number of applied requests: it stops early
+     * once `stop` is raised or `deadline` (ns since the start of the run) passes, so a low rate neither
+     * overshoots the duration of the run nor leaves the timeline without points.
+     */
+    template <class Requests>
+    size_t ApplyOpenLoop(DSU* dsu, const Requests& requests, double& due, LatencyRecorder& latencies,
+                         const std::atomic<bool>* stop, int64_t deadline, auto sinceStart) const {
+        std::exponential_distribution<double> gap(ArrivalRate_ / 1e9);
+        auto* runner = dynamic_cast<RequestRunner*>(dsu);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            while (true) {
+                if (stop && stop->load(std::memory_order_relaxed))
+                    return i;
+                int64_t now = sinceStart();
+                if ((double) now >= due)
+                    break;
+                if (now >= deadline)
+                    return i;
+                CpuRelax();
+            }
+            ApplySpan(dsu, runner, requests.subspan(i, 1), 0.0);
+            int64_t answered = sinceStart();
+            latencies.Add((uint32_t) std::min<double>((double) answered - due, std::numeric_limits<uint32_t>::max()));
+            due += gap(TlRandom);
+            if (answered >= deadline)
+                return i + 1;
+        }
+        return requests.size();
+    }
+
+    // bucket b counts the response times in [2^(b-1), 2^b) ns
+    static Histogram ResponseTimeHistogram(const std::vector<LatencyRecorder>& perThread) {
+        std::vector<size_t> buckets(LatencyRecorder::BUCKETS, 0);
+        for (const LatencyRecorder& recorder : perThread) {
+            for (size_t b = 0; b < buckets.size(); ++b)
+                buckets[b] += recorder.Buckets()[b];
+        }
+        return Histogram(std::move(buckets));
+    }
+
+    static size_t TotalRequests(const StaticWorkload& workload) {
+        size_t total = 0;
+        for (const auto& requests : workload.ThreadRequests)
+            total += requests.size();
+        return std::max<size_t>(total, 1);
+    }
+
+    // request latencies (issue to answer; arrival to answer in the open loop) are reported with the metrics;
+    // they are recorded even without -m, in the closed loop with latency sampling only
+    static void ProduceLatencyMetrics(Metrics& metrics, const std::vector<LatencyRecorder>& perThread) {
+        size_t count = 0;
+        for (const LatencyRecorder& recorder : perThread)
+            count += recorder.Count();
+        if (count == 0)
+            return;
+        metrics["latency_mean_ns"] = LatencyRecorder::Mean(perThread);
+        metrics["latency_p50_ns"] = LatencyRecorder::Quantile(perThread, 0.5);
+        metrics["latency_p99_ns"] = LatencyRecorder::Quantile(perThread, 0.99);
+        metrics["latency_p999_ns"] = LatencyRecorder::Quantile(perThread, 0.999);
+    }
+
+    /*
+     * The makespan is the time from the start of the run to the finish of the last thread. Stragglers show up
+     * as the completion skew, the spread of finish times relative to the makespan, and as the ratio of
+     * the highest throughput of a thread to the lowest one.
+     */
+    static void ProduceCompletionMetrics(Metrics& metrics, const std::vector<ThreadTimeline>& timelines) {
+        size_t total = 0;
+        int64_t firstFinish = std::numeric_limits<int64_t>::max();
+        int64_t lastFinish = 0;
+        double minThroughput = std::numeric_limits<double>::max();
+        double maxThroughput = 0;
+        for (const ThreadTimeline& timeline : timelines) {
+            auto [done, finish] = timeline.Progress.back();
+            total += done;
+            firstFinish = std::min(firstFinish, finish);
+            lastFinish = std::max(lastFinish, finish);
+            double throughput = (double) done / std::max<int64_t>(finish - timeline.Progress[0].second, 1);
+            minThroughput = std::min(minThroughput, throughput);
+            maxThroughput = std::max(maxThroughput, throughput);
         }
+        if (timelines.empty())
+            return;
+        lastFinish = std::max<int64_t>(lastFinish, 1);
+        metrics["makespan_ms"] = lastFinish / 1e6;
+        metrics["makespan_throughput"] = total * 1e9 / lastFinish;
+        metrics["completion_skew"] = (double) (lastFinish - firstFinish) / lastFinish;
+        if (minThroughput > 0)
+            metrics["thread_throughput_imbalance"] = maxThroughput / minThroughput;
     }
 
     static void ProduceSecondaryMetrics(Metrics& metrics) {
@@ -147,6 +566,7 @@ private:
 
         metrics["cross_node_accesses"] = metrics["cross_node_read"] + metrics["cross_node_write"] +
                 metrics["global_data_read_write"];
+        metrics["replicated_wasted"] = metrics["replicated"] - metrics["replicated_reused"];
 
 
         metrics["cross_node_read_in_same_set"] = metrics["cross_node_read_in_false_same_set"] + metrics["cross_node_read_in_true_same_set"];
@@ -202,6 +622,8 @@ private:
         for (const std::string& m : perUnionMetrics) {
             metrics[m + "_per_op"] = metrics[m] / metrics["union_requests"];
         }
+        if (metrics.data().contains("wire_round_trips"))
+            metrics["wire_round_trips_per_op"] = metrics["wire_round_trips"] / metrics["requests"];
     }
 
 private:
@@ -209,5 +631,14 @@ private:
     std::map<DSU*, std::vector<double>> ThroughputResults_;
     std::map<DSU*, std::vector<Metrics>> Metrics_;
     std::map<DSU*, std::vector<HistMetrics>> HistMetrics_;
+    std::map<DSU*, std::vector<std::vector<ThreadTimeline>>> Timelines_;
+    std::map<DSU*, std::vector<std::vector<MetricSample>>> Samples_;
     double AdditionalWork_ = 2.0;
+    bool Routing_ = false;
+    bool BulkPreheat_ = false;
+    bool SampleLatencies_ = false;
+    RequestLayout Layout_ = RequestLayout::AoS;
+    std::chrono::milliseconds Duration_{0};
+    double ArrivalRate_ = 0;
+    std::chrono::milliseconds SamplingPeriod_{0};
 };
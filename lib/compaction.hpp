@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+
+/*
+ * Path compaction of a DSU instance:
+ *  - Full: compress paths as the implementation does (squashing or halving);
+ *  - Halving: compress every other vertex of a path, where the implementation supports it;
+ *  - None: finds never write;
+ *  - Adaptive: every thread switches between the three on-line (see CompactionController).
+ * Implementations without a controller treat Halving and Adaptive as Full.
+ */
+enum class CompactionPolicy {
+    Full,
+    Halving,
+    None,
+    Adaptive
+};
+
+// what a single operation does
+enum class CompactionMode {
+    Full,
+    Halving,
+    None
+};
+
+inline std::string CompactionPolicyName(CompactionPolicy policy) {
+    switch (policy) {
+        case CompactionPolicy::Full: return "full";
+        case CompactionPolicy::Halving: return "halving";
+        case CompactionPolicy::None: return "none";
+        case CompactionPolicy::Adaptive: return "adaptive";
+    }
+    return "unknown";
+}
+
+// "true" and "false" are accepted for full and none
+inline CompactionPolicy ParseCompactionPolicy(const std::string& name) {
+    if (name == "true")
+        return CompactionPolicy::Full;
+    if (name == "false")
+        return CompactionPolicy::None;
+    for (auto policy : {CompactionPolicy::Full, CompactionPolicy::Halving, CompactionPolicy::None, CompactionPolicy::Adaptive}) {
+        if (CompactionPolicyName(policy) == name)
+            return policy;
+    }
+    throw std::runtime_error("Unknown compaction policy: " + name);
+}
+
+/*
+ * Per-thread on-line choice of the compaction mode. Every WINDOW finds the average find depth is compared
+ * with the rate of compaction writes: deep paths switch to full compaction, while short paths that still
+ * cost writes (invalidations of lines other threads read) step down to halving and then to no-write reads.
+ * Without writes paths grow again, and compaction comes back once they are no longer short.
+ */
+class alignas(64) CompactionController {
+public:
+    static constexpr size_t WINDOW = 256;
+    static constexpr double DEEP_PATH = 4.0;     // steps per find
+    static constexpr double SHORT_PATH = 2.0;
+    static constexpr double WRITE_HEAVY = 0.25;  // writes per find
+
+    CompactionMode Mode() const {
+        return Mode_;
+    }
+
+    void CountWrite() {
+        ++Writes_;
+    }
+
+    // returns true if the mode has changed
+    bool Record(size_t depth, size_t finds) {
+        Depth_ += depth;
+        Finds_ += finds;
+        if (Finds_ < WINDOW)
+            return false;
+
+        CompactionMode old = Mode_;
+        double depthPerFind = (double) Depth_ / Finds_;
+        double writesPerFind = (double) Writes_ / Finds_;
+        if (depthPerFind >= DEEP_PATH) {
+            Mode_ = CompactionMode::Full;
+        } else if (depthPerFind <= SHORT_PATH && writesPerFind >= WRITE_HEAVY) {
+            Mode_ = Mode_ == CompactionMode::Full ? CompactionMode::Halving : CompactionMode::None;
+        } else if (Mode_ == CompactionMode::None && depthPerFind > SHORT_PATH) {
+            Mode_ = CompactionMode::Halving;
+        }
+        Depth_ = Finds_ = Writes_ = 0;
+        return Mode_ != old;
+    }
+
+    void Reset() {
+        Mode_ = CompactionMode::Full;
+        Depth_ = Finds_ = Writes_ = 0;
+    }
+
+private:
+    CompactionMode Mode_ = CompactionMode::Full;
+    size_t Depth_ = 0;
+    size_t Finds_ = 0;
+    size_t Writes_ = 0;
+};
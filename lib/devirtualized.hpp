@@ -0,0 +1,67 @@
+#pragma once
+
+#include "workload.hpp"
+#include "util.hpp"
+#include "../DSU.h"
+
+#include <span>
+
+
+/*
+ * A DSU that applies a span of requests with a loop compiled for its own type.
+ * The harness makes one virtual call per span instead of two per request.
+ */
+class RequestRunner {
+public:
+    // RandomAdditionalWork(additionalWork) follows every request
+    virtual void ApplyRequests(std::span<const Request> requests, double additionalWork) = 0;
+    virtual void ApplyRequests(RequestColumns::View requests, double additionalWork) = 0;
+
+    virtual ~RequestRunner() = default;
+};
+
+// the loop of the virtual path, for DSUs which are not RequestRunners
+template <class Requests>
+void ApplyRequestsVirtual(DSU* dsu, const Requests& requests, double additionalWork) {
+    for (size_t i = 0; i < requests.size(); ++i) {
+        requests[i].Apply(dsu);
+        RandomAdditionalWork(additionalWork);
+    }
+}
+
+/*
+ * Final wrapper of an implementation: the loop calls T::DoUnion and T::DoSameSet directly, so they are inlined
+ * and calls on `this` inside them are devirtualized. Metric bookkeeping and frozen mode live in the
+ * DSU::Union/SameSet wrappers, so with either enabled the loop takes the virtual path.
+ */
+template <class T>
+class Devirtualized final : public T, public RequestRunner {
+public:
+    using T::T;
+
+    void ApplyRequests(std::span<const Request> requests, double additionalWork) override {
+        applyRequests(requests, additionalWork);
+    }
+
+    void ApplyRequests(RequestColumns::View requests, double additionalWork) override {
+        applyRequests(requests, additionalWork);
+    }
+
+private:
+    template <class Requests>
+    void applyRequests(const Requests& requests, double additionalWork) {
+        if (DSU::EnableMetrics || this->IsFrozen()) {
+            ApplyRequestsVirtual(this, requests, additionalWork);
+            return;
+        }
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const Request request = requests[i];
+            if (request.IsSameSet()) {
+                Blackhole(T::DoSameSet(request.U(), request.V()));
+            } else {
+                T::DoUnion(request.U(), request.V());
+            }
+            RandomAdditionalWork(additionalWork);
+        }
+    }
+};
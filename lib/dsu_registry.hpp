@@ -0,0 +1,106 @@
+#pragma once
+
+#include "devirtualized.hpp"
+#include "../DSU.h"
+#include "../implementations/DSU_ParallelUnions.h"
+#include "../implementations/DSU_Sequential.h"
+#include "../implementations/DSU_Usual.h"
+#include "../implementations/DSU_Adaptive.h"
+#include "../implementations/DSU_AdaptiveSmart.h"
+#include "../implementations/DSU_AdaptiveLocks.h"
+#include "../implementations/DSU_FC.h"
+#include "../implementations/DSU_LazyUnion.h"
+#include "../implementations/DSU_WireHelping.h"
+#include "../implementations/SeveralDSU.h"
+
+#include <functional>
+#include <memory>
+#include <regex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+/*
+ * A benchmarked implementation: its class name, known before construction, and factories
+ * of the plain and the Devirtualized instances.
+ */
+struct DsuVariant {
+    using Factory = std::function<std::unique_ptr<DSU>(NUMAContext*, size_t)>;
+
+    std::string Name;
+    Factory Make;
+    Factory MakeDevirtualized;
+};
+
+template <class T>
+DsuVariant MakeDsuVariant() {
+    return {T::Name(), [](NUMAContext* ctx, size_t N) -> std::unique_ptr<DSU> {
+        return std::make_unique<T>(ctx, (int) N);
+    }, [](NUMAContext* ctx, size_t N) -> std::unique_ptr<DSU> {
+        return std::make_unique<Devirtualized<T>>(ctx, (int) N);
+    }};
+}
+
+// calls f(std::integral_constant) for each of the values
+template <auto... Values, class F>
+void ForEachValue(F&& f) {
+    (f(std::integral_constant<decltype(Values), Values>{}), ...);
+}
+
+/*
+ * All benchmarked implementations. The Adaptive family and WireHelping are instantiated for the whole
+ * Halfing x Stepping x AllowCrossNodeCompression x LinkingPolicy product. Names of all families mark
+ * AllowCrossNodeCompression=false as "local-compress/" and a non-index linking policy as "link-<policy>/".
+ */
+inline const std::vector<DsuVariant>& GetDsuVariants() {
+    static const std::vector<DsuVariant> variants = [] {
+        std::vector<DsuVariant> res;
+        res.push_back(MakeDsuVariant<DSU_Usual>());
+        res.push_back(MakeDsuVariant<SeveralDSU>());
+
+        ForEachValue<true, false>([&](auto halfing) {
+            constexpr bool H = decltype(halfing)::value;
+            res.push_back(MakeDsuVariant<DSU_ParallelUnions<H>>());
+            ForEachValue<false, true>([&](auto stepping) {
+                constexpr bool S = decltype(stepping)::value;
+                ForEachValue<true, false>([&](auto crossNode) {
+                    constexpr bool C = decltype(crossNode)::value;
+                    ForEachValue<LinkingPolicy::ByIndex, LinkingPolicy::ByPriority>([&](auto linking) {
+                        constexpr LinkingPolicy L = decltype(linking)::value;
+                        res.push_back(MakeDsuVariant<DSU_Adaptive<H, S, C, ReplicationPolicy::Always, L>>());
+                        res.push_back(MakeDsuVariant<DSU_WireHelping<H, S, C, false, L>>());
+                    });
+                });
+            });
+            res.push_back(MakeDsuVariant<DSU_Adaptive<H, false, true, ReplicationPolicy::Never>>());
+            res.push_back(MakeDsuVariant<DSU_Adaptive<H, false, true, ReplicationPolicy::AfterK>>());
+            res.push_back(MakeDsuVariant<DSU_WireHelping<H, false, false, true>>());
+            res.push_back(MakeDsuVariant<DSU_AdaptiveLocks<H>>());
+            res.push_back(MakeDsuVariant<DSU_AdaptiveLocks<H, true>>());
+            res.push_back(MakeDsuVariant<DSU_AdaptiveSmart<H>>());
+            res.push_back(MakeDsuVariant<DSU_AdaptiveSmart<H, true>>());
+            res.push_back(MakeDsuVariant<DSU_FC<H>>());
+            res.push_back(MakeDsuVariant<DSU_LazyUnions<H>>());
+        });
+        return res;
+    }();
+    return variants;
+}
+
+// the single-threaded baseline of the benchmarks; not in GetDsuVariants(), as it cannot run concurrently
+inline const DsuVariant& GetSequentialVariant() {
+    static const DsuVariant variant = MakeDsuVariant<DSU_Sequential>();
+    return variant;
+}
+
+// constructs the variants whose names match the filter
+inline std::vector<std::unique_ptr<DSU>> GetAvailableDsus(NUMAContext* ctx, size_t N, const std::regex& filter,
+                                                          bool devirtualized = false) {
+    std::vector<std::unique_ptr<DSU>> dsus;
+    for (const DsuVariant& variant : GetDsuVariants()) {
+        if (std::regex_match(variant.Name, filter))
+            dsus.push_back((devirtualized ? variant.MakeDevirtualized : variant.Make)(ctx, N));
+    }
+    return dsus;
+}
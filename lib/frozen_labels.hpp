@@ -0,0 +1,137 @@
+#pragma once
+
+#include "numa.hpp"
+#include "node_partition.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <vector>
+
+
+/*
+ * Read-only snapshot of DSU sets: every vertex is mapped to the label of its set.
+ * The label array is replicated on every NUMA node, so a query touches only node-local memory.
+ */
+class FrozenLabels {
+public:
+    FrozenLabels(NUMAContext* ctx, int size)
+            : Ctx_(ctx)
+            , Size_(size) {
+        Labels_.resize(ctx->NodeCount());
+        for (int i = 0; i < (int) Labels_.size(); i++) {
+            Labels_[i] = (int*) Ctx_->Allocate(i, sizeof(int) * size);
+        }
+    }
+
+    FrozenLabels(const FrozenLabels&) = delete;
+    FrozenLabels& operator=(const FrozenLabels&) = delete;
+
+    ~FrozenLabels() {
+        for (int* labels : Labels_) {
+            Ctx_->Free(labels, sizeof(int) * Size_);
+        }
+    }
+
+    /*
+     * Fills the replicas in parallel. Vertices are split into contiguous blocks, one per node,
+     * and every block is split between the threads of its node.
+     * `find` is called from the worker threads, so it may compress paths node-locally.
+     * If `dense` is set, labels are renumbered to 0..k-1 preserving the order of roots.
+     * Must not be called from a worker thread of the same context.
+     */
+    template <class F>
+    void Build(F&& find, bool dense) {
+        int numThreads = (int) Ctx_->MaxConcurrency();
+        NodePartition partition(Ctx_, numThreads, Size_);
+
+        std::vector<int> rootCounts(numThreads, 0);
+        std::vector<int> denseIds(dense ? Size_ : 0);
+        std::barrier barrier(numThreads);
+
+        Ctx_->StartNThreads([&]() {
+            int tid = NUMAContext::CurrentThreadId();
+            int node = NUMAContext::CurrentThreadNode();
+            int* labels = Labels_[node];
+            auto [begin, end] = partition.Chunk(tid);
+
+            for (int u = begin; u < end; ++u) {
+                labels[u] = find(u);
+            }
+
+            if (dense) {
+                int roots = 0;
+                for (int u = begin; u < end; ++u) {
+                    if (labels[u] == u)
+                        ++roots;
+                }
+                rootCounts[tid] = roots;
+                barrier.arrive_and_wait();
+
+                int nextId = 0;
+                for (int oth = 0; oth < numThreads; ++oth) {
+                    if (partition.Chunk(oth).first < begin)
+                        nextId += rootCounts[oth];
+                }
+                for (int u = begin; u < end; ++u) {
+                    if (labels[u] == u)
+                        denseIds[u] = nextId++;
+                }
+                barrier.arrive_and_wait();
+
+                for (int u = begin; u < end; ++u) {
+                    labels[u] = denseIds[labels[u]];
+                }
+            }
+            barrier.arrive_and_wait();
+
+            // replicate blocks computed on other nodes
+            int localThreads = (int) partition.NodeThreads(node).size();
+            for (int srcNode : partition.ActiveNodes()) {
+                if (srcNode == node)
+                    continue;
+                auto [blockBegin, blockEnd] = partition.Block(srcNode);
+                auto [copyBegin, copyEnd] = NodePartition::Split(blockBegin, blockEnd, partition.LocalIndex(tid), localThreads);
+                std::copy(Labels_[srcNode] + copyBegin, Labels_[srcNode] + copyEnd, labels + copyBegin);
+            }
+        }, numThreads);
+        Ctx_->Join();
+
+        ComponentCount_ = 0;
+        for (int count : rootCounts)
+            ComponentCount_ += count;
+        Dense_ = dense;
+    }
+
+    bool SameSet(int u, int v, int node) const {
+        const int* labels = Labels_[node];
+        return labels[u] == labels[v];
+    }
+
+    int Label(int u, int node) const {
+        return Labels_[node][u];
+    }
+
+    const int* NodeLabels(int node) const {
+        return Labels_[node];
+    }
+
+    int Size() const {
+        return Size_;
+    }
+
+    bool Dense() const {
+        return Dense_;
+    }
+
+    // number of sets; known only for dense labels
+    int ComponentCount() const {
+        return ComponentCount_;
+    }
+
+private:
+    NUMAContext* Ctx_;
+    int Size_;
+    std::vector<int*> Labels_;
+    int ComponentCount_ = 0;
+    bool Dense_ = false;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "vertex_pair.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+/*
+ * Bulk SameSet over flat labels (e.g. frozen DSU labels): result bit i is set iff
+ * labels[queries[i].u] == labels[queries[i].v]. Results are packed into 64-bit words.
+ */
+enum class GatherKernel {
+    Auto,
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+inline std::string GatherKernelName(GatherKernel kernel) {
+    switch (kernel) {
+        case GatherKernel::Auto: return "auto";
+        case GatherKernel::Scalar: return "scalar";
+        case GatherKernel::AVX2: return "avx2";
+        case GatherKernel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+inline GatherKernel ParseGatherKernel(const std::string& name) {
+    for (auto kernel : {GatherKernel::Auto, GatherKernel::Scalar, GatherKernel::AVX2, GatherKernel::AVX512}) {
+        if (GatherKernelName(kernel) == name)
+            return kernel;
+    }
+    throw std::runtime_error("Unknown gather kernel: " + name);
+}
+
+inline bool IsGatherKernelSupported(GatherKernel kernel) {
+    switch (kernel) {
+        case GatherKernel::Auto:
+        case GatherKernel::Scalar:
+            return true;
+#if defined(__x86_64__)
+        case GatherKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case GatherKernel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#else
+        default:
+            return false;
+#endif
+    }
+    return false;
+}
+
+inline GatherKernel BestGatherKernel() {
+    static const GatherKernel best = IsGatherKernelSupported(GatherKernel::AVX512) ? GatherKernel::AVX512
+            : IsGatherKernelSupported(GatherKernel::AVX2) ? GatherKernel::AVX2
+            : GatherKernel::Scalar;
+    return best;
+}
+
+inline void GatherSameSetScalar(const int* labels, const VertexPair* queries, size_t n, uint64_t* result) {
+    for (size_t i = 0; i < n; i += 64) {
+        size_t m = std::min<size_t>(64, n - i);
+        uint64_t word = 0;
+        for (size_t j = 0; j < m; ++j) {
+            const VertexPair& q = queries[i + j];
+            word |= static_cast<uint64_t>(labels[q.u] == labels[q.v]) << j;
+        }
+        result[i / 64] = word;
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+inline void GatherSameSetAVX2(const int* labels, const VertexPair* queries, size_t n, uint64_t* result) {
+    // u0 v0 u1 v1 u2 v2 u3 v3 -> u0 u1 u2 u3 v0 v1 v2 v3
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 8) {
+            const int* raw = reinterpret_cast<const int*>(queries + i + j);
+            __m256i a = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*) raw), deinterleave);
+            __m256i b = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*) (raw + 8)), deinterleave);
+            __m256i us = _mm256_permute2x128_si256(a, b, 0x20);
+            __m256i vs = _mm256_permute2x128_si256(a, b, 0x31);
+            __m256i uLabels = _mm256_i32gather_epi32(labels, us, 4);
+            __m256i vLabels = _mm256_i32gather_epi32(labels, vs, 4);
+            auto mask = (unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(uLabels, vLabels)));
+            word |= static_cast<uint64_t>(mask) << j;
+        }
+        result[i / 64] = word;
+    }
+    GatherSameSetScalar(labels, queries + i, n - i, result + i / 64);
+}
+
+__attribute__((target("avx512f")))
+inline void GatherSameSetAVX512(const int* labels, const VertexPair* queries, size_t n, uint64_t* result) {
+    const __m512i evenLanes = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i oddLanes = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 64; j += 16) {
+            const int* raw = reinterpret_cast<const int*>(queries + i + j);
+            __m512i a = _mm512_loadu_si512(raw);
+            __m512i b = _mm512_loadu_si512(raw + 16);
+            __m512i us = _mm512_permutex2var_epi32(a, evenLanes, b);
+            __m512i vs = _mm512_permutex2var_epi32(a, oddLanes, b);
+            // masked form with an explicit source: the unmasked one trips -Wmaybe-uninitialized on GCC 12
+            __m512i uLabels = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, us, labels, 4);
+            __m512i vLabels = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, vs, labels, 4);
+            __mmask16 mask = _mm512_cmpeq_epi32_mask(uLabels, vLabels);
+            word |= static_cast<uint64_t>(mask) << j;
+        }
+        result[i / 64] = word;
+    }
+    GatherSameSetScalar(labels, queries + i, n - i, result + i / 64);
+}
+#endif
+
+/*
+ * `result` must have room for (queries.size() + 63) / 64 words.
+ * Auto selects the widest kernel supported by the CPU.
+ */
+inline void GatherSameSet(const int* labels, std::span<const VertexPair> queries, uint64_t* result,
+                          GatherKernel kernel = GatherKernel::Auto) {
+    if (kernel == GatherKernel::Auto)
+        kernel = BestGatherKernel();
+    REQUIRE(IsGatherKernelSupported(kernel), "Gather kernel is not supported: " + GatherKernelName(kernel));
+    switch (kernel) {
+#if defined(__x86_64__)
+        case GatherKernel::AVX512:
+            GatherSameSetAVX512(labels, queries.data(), queries.size(), result);
+            break;
+        case GatherKernel::AVX2:
+            GatherSameSetAVX2(labels, queries.data(), queries.size(), result);
+            break;
+#endif
+        default:
+            GatherSameSetScalar(labels, queries.data(), queries.size(), result);
+    }
+}
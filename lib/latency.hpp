@@ -0,0 +1,84 @@
+#pragma once
+
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+
+/*
+ * Latencies of one thread (ns) in bounded memory: every latency is counted in a log2 histogram and
+ * the mean, while a uniform sample of at most CAPACITY of them (reservoir sampling) is kept for the quantiles.
+ */
+class LatencyRecorder {
+public:
+    static constexpr size_t CAPACITY = 1 << 16;
+    static constexpr size_t BUCKETS = 33; // bucket b counts the latencies in [2^(b-1), 2^b)
+
+    void Add(uint32_t latency) {
+        ++Buckets_[std::bit_width(latency)];
+        Sum_ += latency;
+        ++Count_;
+        if (Samples_.size() < CAPACITY) {
+            Samples_.push_back(latency);
+            return;
+        }
+        size_t slot = std::uniform_int_distribution<size_t>(0, Count_ - 1)(TlRandom);
+        if (slot < CAPACITY)
+            Samples_[slot] = latency;
+    }
+
+    size_t Count() const {
+        return Count_;
+    }
+
+    const std::array<size_t, BUCKETS>& Buckets() const {
+        return Buckets_;
+    }
+
+    // mean over all recorders, or 0 if none has latencies
+    static double Mean(const std::vector<LatencyRecorder>& recorders) {
+        double sum = 0;
+        size_t count = 0;
+        for (const LatencyRecorder& recorder : recorders) {
+            sum += recorder.Sum_;
+            count += recorder.Count_;
+        }
+        return count ? sum / (double) count : 0;
+    }
+
+    // q-quantile over all recorders; a sample stands for Count() / (its sample size) latencies of its thread
+    static double Quantile(const std::vector<LatencyRecorder>& recorders, double q) {
+        std::vector<std::pair<uint32_t, double>> weighted;
+        double total = 0;
+        for (const LatencyRecorder& recorder : recorders) {
+            if (recorder.Samples_.empty())
+                continue;
+            double weight = (double) recorder.Count_ / (double) recorder.Samples_.size();
+            for (uint32_t latency : recorder.Samples_)
+                weighted.emplace_back(latency, weight);
+            total += (double) recorder.Count_;
+        }
+        if (weighted.empty())
+            return 0;
+        std::sort(weighted.begin(), weighted.end());
+        double rank = q * total, seen = 0;
+        for (auto [latency, weight] : weighted) {
+            seen += weight;
+            if (seen > rank)
+                return latency;
+        }
+        return weighted.back().first;
+    }
+
+private:
+    std::array<size_t, BUCKETS> Buckets_{};
+    double Sum_ = 0;
+    size_t Count_ = 0;
+    std::vector<uint32_t> Samples_;
+};
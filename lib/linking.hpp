@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+
+/*
+ * Which of two roots is hung below the other on union in the Adaptive family:
+ *  - ByIndex: the larger index goes below the smaller one;
+ *  - ByPriority: the lower of implicit pseudorandom priorities goes below the higher one.
+ * Either way parents precede their children in the linking order, which the stepping SameSet relies on.
+ */
+enum class LinkingPolicy {
+    ByIndex,
+    ByPriority
+};
+
+inline std::string LinkingPolicyName(LinkingPolicy policy) {
+    switch (policy) {
+        case LinkingPolicy::ByIndex:
+            return "index";
+        case LinkingPolicy::ByPriority:
+            return "priority";
+    }
+    return "";
+}
+
+// murmur3 finalizer; a bijection, so priorities of different vertices never tie
+constexpr uint32_t LinkPriority(int u) {
+    uint32_t x = uint32_t(u);
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+// true if `u` follows `v` in the linking order, i.e. root `u` is hung below root `v`
+template <LinkingPolicy Linking>
+constexpr bool LinksBelow(int u, int v) {
+    if constexpr (Linking == LinkingPolicy::ByPriority) {
+        return LinkPriority(u) < LinkPriority(v);
+    } else {
+        return u > v;
+    }
+}
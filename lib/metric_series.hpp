@@ -0,0 +1,49 @@
+#pragma once
+
+#include "metrics.hpp"
+#include "csv.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+// metrics of a DSU read while a run goes on; the time is in ns since the start of the run
+struct MetricSample {
+    int64_t Time = 0;
+    Metrics Counters;
+    HistMetrics Histograms;
+};
+
+
+class SeriesCsvFile {
+public:
+    SeriesCsvFile(CsvFile file)
+        : Csv_(std::move(file))
+    {
+        Csv_ << "index" << "time_ns" << "metric" << "point" << "value";
+    }
+
+    // the samples of a run share an index; counters are written with an empty point
+    SeriesCsvFile& operator <<(const std::vector<MetricSample>& run) {
+        size_t index = Index_++;
+        for (const MetricSample& sample : run) {
+            for (const auto& [name, value] : sample.Counters.data()) {
+                Csv_ << index << sample.Time << name << "" << value;
+            }
+            for (const auto& [name, hist] : sample.Histograms.data()) {
+                for (size_t i = 0; i < hist.data().size(); ++i) {
+                    Csv_ << index << sample.Time << name << i << hist[i];
+                }
+            }
+        }
+        return *this;
+    }
+
+    size_t GetNextIndex() const {
+        return Index_;
+    }
+
+private:
+    CsvFile Csv_;
+    size_t Index_ = 0;
+};
@@ -3,6 +3,7 @@
 #include "stats.hpp"
 #include "numa.hpp"
 
+#include <atomic>
 #include <unordered_map>
 #include <string>
 #include <numeric>
@@ -13,6 +14,19 @@
 
 constexpr size_t METRIC_STRIDE = 4; // to reduce false sharing
 
+/*
+ * A slot of a thread is written by the thread alone, so increments are a relaxed load and store rather than
+ * an atomic RMW (plain instructions on x86); relaxed loads let combine() read the slots while threads work.
+ */
+inline void IncrementSlot(size_t& slot, size_t value) {
+    std::atomic_ref<size_t> ref(slot);
+    ref.store(ref.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline size_t ReadSlot(size_t& slot) {
+    return std::atomic_ref<size_t>(slot).load(std::memory_order_relaxed);
+}
+
 template <class V>
 class BaseMetrics {
 private:
@@ -25,10 +39,10 @@ public:
         return metrics[metric];
     }
 
-    const V& operator [](const std::string& metric) const {
+    V operator [](const std::string& metric) const {
         auto it = metrics.find(metric);
         if (it == metrics.end())
-            return 0;
+            return V{};
         return it->second;
     }
 
@@ -136,13 +150,13 @@ public:
 
         void inc(const size_t value, int tid = NUMAContext::CurrentThreadId()) const {
             if (tlMetrics)
-                tlMetrics[tid * METRIC_STRIDE] += value;
+                IncrementSlot(tlMetrics[tid * METRIC_STRIDE], value);
         }
 
         size_t get(int tid = NUMAContext::CurrentThreadId()) const {
             if (!tlMetrics)
                 return 0;
-            return tlMetrics[tid * METRIC_STRIDE];
+            return ReadSlot(tlMetrics[tid * METRIC_STRIDE]);
         }
     };
 
@@ -157,7 +171,7 @@ public:
 
         void inc(const size_t value, int tid = NUMAContext::CurrentThreadId()) const {
             if (tlMetrics)
-                tlMetrics[tid][value < maxValue ? value : maxValue] += 1;
+                IncrementSlot(tlMetrics[tid][value < maxValue ? value : maxValue - 1], 1);
         }
     };
 
@@ -191,11 +205,15 @@ public:
         return HistAccessor(tlMetrics.data(), max);
     }
 
+    // may be called while the threads work: the result is then a snapshot of every slot, not a consistent cut
     Metrics combine() {
         Metrics res;
         std::lock_guard lock(mutex);
-        for (const auto& [key, tlMetrics] : allMetrics) {
-            res[key] = std::reduce(tlMetrics.begin(), tlMetrics.end());
+        for (auto& [key, tlMetrics] : allMetrics) {
+            size_t sum = 0;
+            for (size_t& slot : tlMetrics)
+                sum += ReadSlot(slot);
+            res[key] = sum;
         }
         return res;
     }
@@ -203,9 +221,12 @@ public:
     HistMetrics combineHist() {
         HistMetrics res;
         std::lock_guard lock(mutex);
-        for (const auto& [key, tlMetrics] : allHistMetrics) {
-            for (const auto& vec : tlMetrics) {
-                res[key] += Histogram(vec);
+        for (auto& [key, tlMetrics] : allHistMetrics) {
+            for (auto& vec : tlMetrics) {
+                std::vector<size_t> snapshot(vec.size());
+                for (size_t i = 0; i < vec.size(); ++i)
+                    snapshot[i] = ReadSlot(vec[i]);
+                res[key] += Histogram(std::move(snapshot));
             }
         }
         return HistMetrics{res};
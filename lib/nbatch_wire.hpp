@@ -0,0 +1,194 @@
+#pragma once
+
+#include "numa.hpp"
+#include "wait_policy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <vector>
+
+
+/*
+ * Delegation channels: a ring of Depth channels of K request slots per (owner node, client thread),
+ * allocated on the owner node. A client posts up to K requests at once and may keep up to Depth batches
+ * in flight; the responses are awaited in the order of posting. Any thread of the owner node
+ * may claim a channel, serve the whole batch and publish the responses together with the state
+ * in a single cache line.
+ *
+ * Channel states: IDLE -> REQUEST (client) -> SERVING (server) -> RESPONSE (server) -> IDLE (client).
+ * A client may withdraw an unclaimed request (REQUEST -> IDLE). A node without servers
+ * has its channels poisoned, and posting to them fails.
+ */
+template <int K, int Depth = 4>
+class NBatchWire {
+public:
+    static_assert(K <= 15, "Responses and the state must share a cache line");
+
+    explicit NBatchWire(NUMAContext* ctx)
+            : Ctx_(ctx)
+            , NumClients_((int) ctx->MaxConcurrency())
+            , Channels_(ctx->NodeCount())
+            , Cursors_(ctx->NodeCount() * ctx->MaxConcurrency()) {
+        for (int node = 0; node < (int) Channels_.size(); ++node) {
+            Channels_[node] = (Channel*) Ctx_->Allocate(node, sizeof(Channel) * NumClients_ * Depth);
+            for (int i = 0; i < NumClients_ * Depth; ++i) {
+                new (&Channels_[node][i]) Channel();
+            }
+        }
+    }
+
+    NBatchWire(const NBatchWire&) = delete;
+    NBatchWire& operator=(const NBatchWire&) = delete;
+
+    ~NBatchWire() {
+        for (Channel* channels : Channels_) {
+            Ctx_->Free(channels, sizeof(Channel) * NumClients_ * Depth);
+        }
+    }
+
+    // reopens all channels; no thread may use the wire concurrently
+    void Reset() {
+        for (Channel* channels : Channels_) {
+            for (int i = 0; i < NumClients_ * Depth; ++i) {
+                channels[i].state.store(IDLE, std::memory_order_relaxed);
+            }
+        }
+        std::fill(Cursors_.begin(), Cursors_.end(), Cursor{});
+    }
+
+    // number of batches the client has posted to the owner and not awaited yet
+    int InFlight(int owner, int client) const {
+        const Cursor& cursor = Cursors_[owner * NumClients_ + client];
+        return (int) (cursor.posted - cursor.awaited);
+    }
+
+    // returns false if the ring of the client is full or the owner node does not serve requests anymore
+    bool Post(int owner, int client, const int* requests, int count) {
+        Cursor& cursor = Cursors_[owner * NumClients_ + client];
+        if (cursor.posted - cursor.awaited == Depth)
+            return false;
+        Channel& ch = channel(owner, client, cursor.posted);
+        std::copy(requests, requests + count, ch.requests);
+        ch.count = count;
+        int expected = IDLE;
+        if (!ch.state.compare_exchange_strong(expected, REQUEST, std::memory_order_release, std::memory_order_relaxed))
+            return false;
+        ++cursor.posted;
+        return true;
+    }
+
+    /*
+     * Waits for the responses to the oldest batch in flight calling `idle()` between polls.
+     * A request still unclaimed after `patience` is withdrawn and false is returned.
+     */
+    template <class F>
+    bool Await(int owner, int client, int* responses, int count, F&& idle, std::chrono::nanoseconds patience) {
+        constexpr size_t FREE_POLLS = 16; // polls before the clock is consulted
+        Cursor& cursor = Cursors_[owner * NumClients_ + client];
+        Channel& ch = channel(owner, client, cursor.awaited++);
+        auto start = std::chrono::steady_clock::now();
+        size_t polls = 0;
+        while (true) {
+            int state = ch.state.load(std::memory_order_acquire);
+            if (state == RESPONSE) {
+                std::copy(ch.responses, ch.responses + count, responses);
+                ch.state.store(IDLE, std::memory_order_relaxed);
+                return true;
+            }
+            if (state == REQUEST && ++polls >= FREE_POLLS && std::chrono::steady_clock::now() - start >= patience) {
+                int expected = REQUEST;
+                if (ch.state.compare_exchange_strong(expected, IDLE, std::memory_order_relaxed))
+                    return false;
+                continue;
+            }
+            idle();
+        }
+    }
+
+    /*
+     * Serves the batches the client has posted to the owner: `serve(requests, responses, count)` fills the responses.
+     * Returns the number of served batches.
+     */
+    template <class F>
+    int Serve(int owner, int client, F&& serve) {
+        int served = 0;
+        for (int slot = 0; slot < Depth; ++slot) {
+            served += serveChannel(channel(owner, client, slot), serve);
+        }
+        return served;
+    }
+
+    // closes all channels of the node for new requests; pending requests are served, waiting as `policy` says
+    template <class F>
+    void Poison(int owner, WaitPolicy policy, F&& serve) {
+        for (int client = 0; client < NumClients_; ++client) {
+            for (int slot = 0; slot < Depth; ++slot) {
+                Channel& ch = channel(owner, client, slot);
+                Waiter waiter(policy);
+                while (true) {
+                    int expected = IDLE;
+                    if (ch.state.compare_exchange_strong(expected, POISON) || expected == POISON)
+                        break;
+                    if (!serveChannel(ch, serve))
+                        waiter.Pause();
+                }
+            }
+        }
+    }
+
+    // reopens the poisoned channels of the node; requires that no thread poisons it concurrently
+    void Reopen(int owner) {
+        for (int i = 0; i < NumClients_ * Depth; ++i) {
+            int expected = POISON;
+            Channels_[owner][i].state.compare_exchange_strong(expected, IDLE);
+        }
+    }
+
+    static constexpr int Slots = K;
+    static constexpr int Batches = Depth;
+
+private:
+    static constexpr int IDLE = 0;
+    static constexpr int REQUEST = 1;
+    static constexpr int SERVING = 2;
+    static constexpr int RESPONSE = 3;
+    static constexpr int POISON = 4;
+
+    struct alignas(64) Channel {
+        // written by the client
+        int requests[K];
+        int count = 0;
+
+        // written by the server
+        alignas(64) std::atomic<int> state{IDLE};
+        int responses[K];
+    };
+
+    // ring positions of a (owner, client) pair; touched by the client only
+    struct alignas(64) Cursor {
+        size_t posted = 0;
+        size_t awaited = 0;
+    };
+
+    template <class F>
+    static bool serveChannel(Channel& ch, F&& serve) {
+        int expected = REQUEST;
+        if (ch.state.load(std::memory_order_relaxed) != REQUEST
+                || !ch.state.compare_exchange_strong(expected, SERVING, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        serve(ch.requests, ch.responses, ch.count);
+        ch.state.store(RESPONSE, std::memory_order_release);
+        return true;
+    }
+
+    Channel& channel(int owner, int client, size_t position) {
+        return Channels_[owner][client * Depth + position % Depth];
+    }
+
+    NUMAContext* Ctx_;
+    int NumClients_;
+    std::vector<Channel*> Channels_;
+    std::vector<Cursor> Cursors_; // per (owner, client)
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "numa.hpp"
+
+#include <utility>
+#include <vector>
+
+
+/*
+ * Splits [0, size) between worker threads 0..numThreads-1: one contiguous block per node that has threads,
+ * and every block between the threads of its node. Chunks are ordered by (node, thread).
+ */
+class NodePartition {
+public:
+    NodePartition(const NUMAContext* ctx, int numThreads, int size)
+            : NodeThreads_(ctx->NodeCount())
+            , Blocks_(ctx->NodeCount(), {0, 0})
+            , Chunks_(numThreads)
+            , LocalIndex_(numThreads) {
+        for (int tid = 0; tid < numThreads; ++tid) {
+            auto& tids = NodeThreads_[ctx->NumaNodeForThread(tid)];
+            LocalIndex_[tid] = (int) tids.size();
+            tids.push_back(tid);
+        }
+        for (int node = 0; node < (int) NodeThreads_.size(); ++node) {
+            if (!NodeThreads_[node].empty())
+                ActiveNodes_.push_back(node);
+        }
+
+        for (size_t blockId = 0; blockId < ActiveNodes_.size(); ++blockId) {
+            int node = ActiveNodes_[blockId];
+            Blocks_[node] = Split(0, size, (int) blockId, (int) ActiveNodes_.size());
+            const auto& tids = NodeThreads_[node];
+            for (size_t j = 0; j < tids.size(); ++j) {
+                Chunks_[tids[j]] = Split(Blocks_[node].first, Blocks_[node].second, (int) j, (int) tids.size());
+            }
+        }
+    }
+
+    std::pair<int, int> Chunk(int tid) const {
+        return Chunks_[tid];
+    }
+
+    // empty for nodes without threads
+    std::pair<int, int> Block(int node) const {
+        return Blocks_[node];
+    }
+
+    const std::vector<int>& NodeThreads(int node) const {
+        return NodeThreads_[node];
+    }
+
+    // index of the thread among the threads of its node
+    int LocalIndex(int tid) const {
+        return LocalIndex_[tid];
+    }
+
+    const std::vector<int>& ActiveNodes() const {
+        return ActiveNodes_;
+    }
+
+    int NumThreads() const {
+        return (int) Chunks_.size();
+    }
+
+    static std::pair<int, int> Split(int begin, int end, int part, int parts) {
+        long long len = end - begin;
+        return {begin + (int) (len * part / parts), begin + (int) (len * (part + 1) / parts)};
+    }
+
+private:
+    std::vector<std::vector<int>> NodeThreads_;
+    std::vector<std::pair<int, int>> Blocks_;
+    std::vector<std::pair<int, int>> Chunks_;
+    std::vector<int> LocalIndex_;
+    std::vector<int> ActiveNodes_;
+};
@@ -7,6 +7,8 @@
 #include <thread>
 #include <stdexcept>
 #include <cmath>
+#include <string>
+#include <algorithm>
 
 #include <sched.h>
 #include <numa.h>
@@ -30,6 +32,32 @@ class NUMAContext;
 //    NUMAContext* Ctx_;
 //};
 
+/*
+ * Order in which worker threads take CPUs:
+ *  - compact: fill a node before moving to the next one;
+ *  - spread: round-robin over the nodes.
+ */
+enum class ThreadPlacement {
+    Compact,
+    Spread
+};
+
+inline std::string ThreadPlacementName(ThreadPlacement placement) {
+    switch (placement) {
+        case ThreadPlacement::Compact: return "compact";
+        case ThreadPlacement::Spread: return "spread";
+    }
+    return "unknown";
+}
+
+inline ThreadPlacement ParseThreadPlacement(const std::string& name) {
+    for (auto placement : {ThreadPlacement::Compact, ThreadPlacement::Spread}) {
+        if (ThreadPlacementName(placement) == name)
+            return placement;
+    }
+    throw std::runtime_error("Invalid thread placement: " + name);
+}
+
 static thread_local NUMAContext* NumaCtx;
 static thread_local int ThreadId;
 static thread_local int NumaNodeId;
@@ -48,6 +76,48 @@ public:
         TestingNumaIds_ = true;
         NumCpu_ = numCpu;
         NumNuma_ = numNuma;
+        Workers_ = 0;
+        CpuOrder_.clear();
+    }
+
+    /*
+     * Number of worker threads the workloads are built for, and the CPUs threads 0, 1, ... take.
+     * Threads beyond the count (e.g. of BulkBuild) keep following the same order.
+     */
+    void SetWorkers(size_t count, ThreadPlacement placement) {
+        REQUIRE(count >= 1 && count <= MaxConcurrency(),
+                "Worker count must be in [1, " + std::to_string(MaxConcurrency()) + "]");
+        Workers_ = count;
+        std::vector<std::vector<int>> nodeCpus(NumNuma_);
+        for (int cpu = 0; cpu < (int) NumCpu_; ++cpu) {
+            nodeCpus[std::max(NodeOfCpu(cpu), 0)].push_back(cpu);
+        }
+        CpuOrder_.clear();
+        if (placement == ThreadPlacement::Compact) {
+            for (const auto& cpus : nodeCpus)
+                CpuOrder_.insert(CpuOrder_.end(), cpus.begin(), cpus.end());
+        } else {
+            for (size_t i = 0; CpuOrder_.size() < NumCpu_; ++i) {
+                for (const auto& cpus : nodeCpus) {
+                    if (i < cpus.size())
+                        CpuOrder_.push_back(cpus[i]);
+                }
+            }
+        }
+    }
+
+    // MaxConcurrency() unless SetWorkers() was called
+    size_t WorkerCount() const {
+        return Workers_ ? Workers_ : MaxConcurrency();
+    }
+
+    /*
+     * Runs `factor` worker threads per CPU: MaxConcurrency() grows accordingly,
+     * and thread `tid` shares the CPU (and the node) of thread `tid % cpus`.
+     */
+    void SetOversubscription(size_t factor) {
+        REQUIRE(factor >= 1, "Oversubscription factor must be positive");
+        Oversubscription_ = factor;
     }
 
     template <class R>
@@ -69,16 +139,56 @@ public:
             StartThread(runnable);
     }
 
+    /*
+     * Starts a thread outside of the worker pool, pinned to ServiceCpu(node).
+     * Its id is MaxConcurrency() + node. The caller owns the thread and must join it.
+     */
+    template <class R>
+    std::thread StartServiceThread(int node, R runnable) {
+        int cpu = ServiceCpu(node);
+        return std::thread([this, node, cpu, runnable]() {
+            NumaCtx = this;
+            ThreadId = (int) MaxConcurrency() + node;
+            NumaNodeId = node;
+            if (cpu != -1)
+                PinToCpu(cpu);
+            runnable();
+        });
+    }
+
+    /*
+     * The last CPU of the node that no worker thread takes, so service threads do not steal worker time.
+     * If the workers take every CPU of the node, the service thread shares the last one with a worker.
+     * -1 if the node has no CPUs.
+     */
+    int ServiceCpu(int node) const {
+        std::vector<bool> taken(NumCpu_);
+        for (int tid = 0; tid < (int) std::min(WorkerCount(), NumCpu_); ++tid) {
+            taken[CpuForThread(tid)] = true;
+        }
+        int cpu = -1;
+        for (int c = 0; c < (int) NumCpu_; ++c) {
+            if (NodeOfCpu(c) == node && (cpu == -1 || !taken[c] || taken[cpu]))
+                cpu = c;
+        }
+        return cpu;
+    }
+
     size_t NodeCount() const {
         return NumNuma_;
     }
 
     size_t MaxConcurrency() const {
-        return NumCpu_;
+        return NumCpu_ * Oversubscription_;
     }
 
     int NumaNodeForThread(int tid) const {
-        return TestingNumaIds_ ? (tid * (int)NumNuma_ / (int)NumCpu_) : numa_node_of_cpu(tid % (int) NumCpu_);
+        return NodeOfCpu(CpuForThread(tid));
+    }
+
+    int CpuForThread(int tid) const {
+        int cpuId = tid % (int) NumCpu_;
+        return CpuOrder_.empty() ? cpuId : CpuOrder_[cpuId];
     }
 
     void Join() {
@@ -97,6 +207,12 @@ public:
         }
     }
 
+    // heap allocations of the calling thread prefer the node from now on; no-op without NUMA
+    void PreferNode(int nodeId) const {
+        if (NumaAvailable_)
+            numa_set_preferred(nodeId % (numa_max_node() + 1));
+    }
+
     void Free(void* ptr, size_t size) const {
         if (NumaAvailable_) {
             numa_free(ptr, size);
@@ -128,13 +244,21 @@ private:
         NumaCtx = this;
         ThreadId = id;
 
+        int cpuId = CpuForThread(id);
+        PinToCpu(cpuId);
+
+        NumaNodeId = NodeOfCpu(cpuId);
+    }
+
+    int NodeOfCpu(int cpuId) const {
+        return TestingNumaIds_ ? (cpuId * (int)NumNuma_ / (int)NumCpu_) : numa_node_of_cpu(cpuId);
+    }
+
+    static void PinToCpu(int cpuId) {
         cpu_set_t cpuset;
         CPU_ZERO(&cpuset);
-        int cpuId = id % (int) NumCpu_;
         CPU_SET(cpuId, &cpuset);
         pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
-
-        NumaNodeId = TestingNumaIds_ ? (id * (int)NumNuma_ / (int)NumCpu_) : numa_node_of_cpu(cpuId);
     }
 
     void ValidateTopology() const {
@@ -149,6 +273,9 @@ private:
 
     std::vector<std::thread> Threads_;
     size_t NumCpu_;
+    size_t Oversubscription_ = 1;
+    size_t Workers_ = 0;
+    std::vector<int> CpuOrder_; // CPU of thread `tid % NumCpu_`; identity if empty
     size_t NumNuma_;
     bool TestingNumaIds_;
     bool NumaAvailable_;
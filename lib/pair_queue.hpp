@@ -0,0 +1,75 @@
+#pragma once
+
+#include "numa.hpp"
+#include "util.hpp"
+
+#include <cstdint>
+#include <new>
+#include <string>
+
+
+/*
+ * Adapts a vendored ConcurrencyFreaks queue (utils/ConcurrencyFreaks/queues) to an MPMC queue of vertex pairs
+ * with a home node, the shape a union propagation or delegation engine consumes.
+ * The queue object is allocated on the home node. Queue nodes are allocated by the enqueuing thread,
+ * so producers should call NUMAContext::PreferNode(Node()) to keep them there.
+ * A pair is packed into the item pointer itself, so nothing is allocated per request.
+ */
+template <template <class> class Q>
+class PairQueue {
+public:
+    static constexpr int MAX_THREADS = 128; // hazard pointer limit of the vendored queues
+
+    PairQueue(NUMAContext* ctx, int node)
+            : Ctx_(ctx)
+            , Node_(node) {
+        // worker threads and one service thread per node
+        int maxThreads = (int) (ctx->MaxConcurrency() + ctx->NodeCount());
+        REQUIRE(maxThreads <= MAX_THREADS, "Too many threads for the vendored queues");
+        Queue_ = new (Ctx_->Allocate(node, sizeof(Q<void>))) Q<void>(maxThreads);
+    }
+
+    PairQueue(const PairQueue&) = delete;
+    PairQueue& operator=(const PairQueue&) = delete;
+
+    ~PairQueue() {
+        Queue_->~Q<void>();
+        Ctx_->Free(Queue_, sizeof(Q<void>));
+    }
+
+    void Push(int u, int v) {
+        Queue_->enqueue(pack(u, v), NUMAContext::CurrentThreadId());
+    }
+
+    bool TryPop(int& u, int& v) {
+        void* item = Queue_->dequeue(NUMAContext::CurrentThreadId());
+        if (!item)
+            return false;
+        auto bits = reinterpret_cast<uintptr_t>(item);
+        u = (int) ((bits >> 31) & PAIR_MASK);
+        v = (int) (bits & PAIR_MASK);
+        return true;
+    }
+
+    int Node() const {
+        return Node_;
+    }
+
+    std::string Name() const {
+        return Queue_->className();
+    }
+
+private:
+    static constexpr uintptr_t PAIR_MASK = (uintptr_t(1) << 31) - 1;
+    static constexpr uintptr_t NON_NULL = uintptr_t(1) << 63; // never a heap address the queues may use
+
+    static_assert(sizeof(uintptr_t) == 8, "Pairs are packed into 64-bit pointers");
+
+    static void* pack(int u, int v) {
+        return reinterpret_cast<void*>(NON_NULL | (uintptr_t(u) << 31) | uintptr_t(v));
+    }
+
+    NUMAContext* Ctx_;
+    int Node_;
+    Q<void>* Queue_;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+
+/*
+ * When the Adaptive family copies a remotely read non-root vertex into the local replica:
+ * on every remote read, never, or once the vertex has been read remotely REPLICATION_AFTER_K times.
+ */
+enum class ReplicationPolicy {
+    Always,
+    Never,
+    AfterK
+};
+
+constexpr int REPLICATION_AFTER_K = 4;
+
+inline std::string ReplicationPolicyName(ReplicationPolicy policy) {
+    switch (policy) {
+        case ReplicationPolicy::Always:
+            return "always";
+        case ReplicationPolicy::Never:
+            return "never";
+        case ReplicationPolicy::AfterK:
+            return "after" + std::to_string(REPLICATION_AFTER_K);
+    }
+    return "";
+}
+
+/*
+ * Remote read counts of one node: a single row of saturating 8-bit counters indexed by a hash of the vertex,
+ * one counter per 4 vertices, allocated on the node. Collisions only make replication happen earlier.
+ * Counters are bumped with relaxed load/store pairs, so concurrent reads of the same slot are sampled
+ * rather than all counted.
+ */
+class RemoteReadSketch {
+public:
+    RemoteReadSketch(NUMAContext* ctx, int node, int size)
+            : Ctx_(ctx) {
+        while ((1 << Bits_) < std::max(size / 4, 64))
+            ++Bits_;
+        Counters_ = (std::atomic<uint8_t>*) Ctx_->Allocate(node, sizeof(std::atomic<uint8_t>) * Slots());
+        Reset();
+    }
+
+    RemoteReadSketch(const RemoteReadSketch&) = delete;
+    RemoteReadSketch& operator=(const RemoteReadSketch&) = delete;
+
+    ~RemoteReadSketch() {
+        Ctx_->Free(Counters_, sizeof(std::atomic<uint8_t>) * Slots());
+    }
+
+    void Reset() {
+        for (size_t i = 0; i < Slots(); ++i) {
+            Counters_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // counts a remote read of `u`; true if `u` has been read at least `k` times
+    bool CountAndCheck(int u, int k) {
+        std::atomic<uint8_t>& counter = Counters_[slot(u)];
+        uint8_t count = counter.load(std::memory_order_relaxed);
+        if (count < UINT8_MAX)
+            counter.store(++count, std::memory_order_relaxed);
+        return count >= k;
+    }
+
+    bool Check(int u, int k) const {
+        return Counters_[slot(u)].load(std::memory_order_relaxed) >= k;
+    }
+
+private:
+    size_t Slots() const {
+        return size_t(1) << Bits_;
+    }
+
+    size_t slot(int u) const {
+        return (uint32_t(u) * 0x9E3779B1u) >> (32 - Bits_);
+    }
+
+    NUMAContext* Ctx_;
+    int Bits_ = 6;
+    std::atomic<uint8_t>* Counters_;
+};
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "workload.hpp"
+#include "numa.hpp"
+#include "node_partition.hpp"
+#include "util.hpp"
+#include "latency.hpp"
+#include "../DSU.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <vector>
+
+
+/*
+ * Owner-routed dispatch: a request whose vertices are both owned by another node (the ownership map set by
+ * PrepareDSUForWorkload) is forwarded to that node's MPSC queue; the other requests are applied in place,
+ * and those whose vertices have different owners are counted as cross-node. The MPSC queue of a node is made
+ * of one SPSC lane per producer thread allocated on that node. Lane (node, producer) is drained by the thread `producer % threads(node)` of the node,
+ * which writes the answer back into the completion slot of the lane entry.
+ *
+ * Every worker thread is both a producer of its own request stream and a server of its lanes.
+ */
+class RequestRouter {
+public:
+    static constexpr int LANE_CAPACITY = 64; // requests in flight per lane
+    static constexpr size_t LATENCY_SAMPLE_PERIOD = 64; // every k-th request of a producer is timed
+
+    RequestRouter(NUMAContext* ctx, int numThreads, const int* owners)
+            : Ctx_(ctx)
+            , NumThreads_(numThreads)
+            , Owners_(owners)
+            , Partition_(ctx, numThreads, 0)
+            , Lanes_(ctx->NodeCount()) {
+        for (int node = 0; node < (int) Lanes_.size(); ++node) {
+            Lanes_[node] = (Lane*) Ctx_->Allocate(node, sizeof(Lane) * NumThreads_);
+            for (int producer = 0; producer < NumThreads_; ++producer) {
+                new (&Lanes_[node][producer]) Lane();
+            }
+        }
+    }
+
+    RequestRouter(const RequestRouter&) = delete;
+    RequestRouter& operator=(const RequestRouter&) = delete;
+
+    ~RequestRouter() {
+        for (Lane* lanes : Lanes_) {
+            Ctx_->Free(lanes, sizeof(Lane) * NumThreads_);
+        }
+    }
+
+    /*
+     * Called by every worker thread with its own request stream. `afterRequest()` is called by the producer
+     * after issuing each request, and latencies of the sampled requests are recorded in `latencies` (ns).
+     * Returns the time it took to complete the own stream; the thread then keeps serving
+     * its lanes until all producers are done.
+     */
+    template <class F>
+    std::chrono::nanoseconds Run(DSU* dsu, std::span<const Request> requests, F&& afterRequest,
+                                 LatencyRecorder& latencies) {
+        int tid = NUMAContext::CurrentThreadId();
+        int node = NUMAContext::CurrentThreadNode();
+        std::vector<Lane*> ownLanes;
+        for (int srcNode = 0; srcNode < (int) Lanes_.size(); ++srcNode) {
+            ownLanes.push_back(&Lanes_[srcNode][tid]);
+        }
+        std::vector<Lane*> servedLanes;
+        const auto& localThreads = Partition_.NodeThreads(node);
+        for (int producer = 0; producer < NumThreads_; ++producer) {
+            if (localThreads[producer % localThreads.size()] == tid)
+                servedLanes.push_back(&Lanes_[node][producer]);
+        }
+
+        auto serve = [&]() {
+            for (Lane* lane : servedLanes) {
+                while (true) {
+                    Entry& e = lane->entries[lane->served % LANE_CAPACITY];
+                    if (e.state.load(std::memory_order_acquire) != POSTED)
+                        break;
+                    e.answer = apply(dsu, e.request);
+                    e.state.store(DONE, std::memory_order_release);
+                    ++lane->served;
+                }
+            }
+        };
+
+        size_t inFlight = 0;
+        auto retire = [&]() {
+            for (Lane* lane : ownLanes) {
+                while (lane->retired != lane->posted) {
+                    Entry& e = lane->entries[lane->retired % LANE_CAPACITY];
+                    if (e.state.load(std::memory_order_acquire) != DONE)
+                        break;
+                    Blackhole(e.answer);
+                    if (e.postedAt != 0)
+                        latencies.Add((uint32_t) (now() - e.postedAt));
+                    e.state.store(EMPTY, std::memory_order_relaxed);
+                    ++lane->retired;
+                    --inFlight;
+                }
+            }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const Request& request = requests[i];
+            bool sampled = i % LATENCY_SAMPLE_PERIOD == 0;
+            int owner = Owners_[request.U()];
+            if (owner != Owners_[request.V()]) {
+                ++CrossNode_[tid].value;
+                owner = node;
+            }
+            if (owner == node || Partition_.NodeThreads(owner).empty()) {
+                int64_t postedAt = sampled ? now() : 0;
+                Blackhole(apply(dsu, request));
+                if (sampled)
+                    latencies.Add((uint32_t) (now() - postedAt));
+            } else {
+                Lane& lane = *ownLanes[owner];
+                Entry& e = lane.entries[lane.posted % LANE_CAPACITY];
+                while (e.state.load(std::memory_order_acquire) != EMPTY) {
+                    serve();
+                    retire();
+                }
+                e.request = request;
+                e.postedAt = sampled ? now() : 0;
+                e.state.store(POSTED, std::memory_order_release);
+                ++lane.posted;
+                ++inFlight;
+                ++Routed_[tid].value;
+            }
+            afterRequest();
+            serve();
+            retire();
+        }
+        while (inFlight > 0) {
+            serve();
+            retire();
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+
+        Finished_.fetch_add(1, std::memory_order_release);
+        while (Finished_.load(std::memory_order_acquire) < NumThreads_) {
+            serve();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+    }
+
+    // number of requests forwarded to another node
+    size_t RoutedRequests() const {
+        return Total(Routed_);
+    }
+
+    // number of requests whose vertices are owned by different nodes; they are applied in place
+    size_t CrossNodeRequests() const {
+        return Total(CrossNode_);
+    }
+
+private:
+    static constexpr uint8_t EMPTY = 0;
+    static constexpr uint8_t POSTED = 1;
+    static constexpr uint8_t DONE = 2;
+
+    struct alignas(32) Entry {
+        std::atomic<uint8_t> state{EMPTY};
+        bool answer = false;
+        Request request{};
+        int64_t postedAt = 0;
+    };
+
+    struct alignas(64) Lane {
+        Entry entries[LANE_CAPACITY];
+        alignas(64) size_t posted = 0;  // producer only
+        size_t retired = 0;             // producer only
+        alignas(64) size_t served = 0;  // server only
+    };
+
+    struct alignas(64) Counter {
+        size_t value = 0;
+    };
+
+    static bool apply(DSU* dsu, const Request& request) {
+        if (request.IsSameSet())
+            return dsu->SameSet(request.U(), request.V());
+        dsu->Union(request.U(), request.V());
+        return false;
+    }
+
+    static size_t Total(const std::vector<Counter>& counters) {
+        size_t total = 0;
+        for (const auto& counter : counters)
+            total += counter.value;
+        return total;
+    }
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    NUMAContext* Ctx_;
+    int NumThreads_;
+    const int* Owners_;
+    NodePartition Partition_;
+    std::vector<Lane*> Lanes_; // [node][producer]
+    std::vector<Counter> Routed_ = std::vector<Counter>(NumThreads_);
+    std::vector<Counter> CrossNode_ = std::vector<Counter>(NumThreads_);
+    std::atomic<int> Finished_{0};
+};
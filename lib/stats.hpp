@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
+#include <vector>
 
 template <class V>
 struct Stats {
@@ -69,3 +71,13 @@ Stats<V> stats(const It begin, const It end) {
     V stddev = n == 1 ? V{} : std::sqrt(sqSum / (n - 1));
     return {mean, stddev};
 }
+
+// q-quantile of the values (nearest rank); reorders the values
+template <class V>
+V quantile(std::vector<V>& values, double q) {
+    if (values.empty())
+        return V{};
+    auto nth = values.begin() + std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "csv.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+/*
+ * Progress of a worker thread in a measured run: (requests done, ns since the start of the run),
+ * from (0, start of the thread) to (all requests done, finish of the thread).
+ */
+struct ThreadTimeline {
+    int Thread = 0;
+    int Node = 0;
+    std::vector<std::pair<size_t, int64_t>> Progress;
+};
+
+
+class TimelineCsvFile {
+public:
+    TimelineCsvFile(CsvFile file)
+        : Csv_(std::move(file))
+    {
+        Csv_ << "index" << "thread" << "node" << "requests" << "time_ns";
+    }
+
+    // the timelines of all threads of a run share an index
+    TimelineCsvFile& operator <<(const std::vector<ThreadTimeline>& run) {
+        size_t index = Index_++;
+        for (const ThreadTimeline& timeline : run) {
+            for (auto [requests, time] : timeline.Progress) {
+                Csv_ << index << timeline.Thread << timeline.Node << requests << time;
+            }
+        }
+        return *this;
+    }
+
+    size_t GetNextIndex() const {
+        return Index_;
+    }
+
+private:
+    CsvFile Csv_;
+    size_t Index_ = 0;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+
+// a pair of vertices: a query or an edge; layout is relied upon by vectorised kernels
+struct VertexPair {
+    int u, v;
+};
+
+static_assert(sizeof(VertexPair) == 2 * sizeof(int));
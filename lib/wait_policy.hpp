@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+
+/*
+ * How a thread waits for a condition owned by another thread:
+ *  - Spin: pause instruction between checks;
+ *  - Backoff: exponentially growing runs of pauses;
+ *  - Yield: spin for a while, then give the CPU away between checks;
+ *  - Park: spin for a while, then sleep on the awaited word until it is notified.
+ * Spinning policies are fastest with a core per thread; yielding and parking survive oversubscription.
+ */
+enum class WaitPolicy {
+    Spin,
+    Backoff,
+    Yield,
+    Park
+};
+
+inline std::string WaitPolicyName(WaitPolicy policy) {
+    switch (policy) {
+        case WaitPolicy::Spin: return "spin";
+        case WaitPolicy::Backoff: return "backoff";
+        case WaitPolicy::Yield: return "yield";
+        case WaitPolicy::Park: return "park";
+    }
+    return "unknown";
+}
+
+inline WaitPolicy ParseWaitPolicy(const std::string& name) {
+    for (auto policy : {WaitPolicy::Spin, WaitPolicy::Backoff, WaitPolicy::Yield, WaitPolicy::Park}) {
+        if (WaitPolicyName(policy) == name)
+            return policy;
+    }
+    throw std::runtime_error("Unknown wait policy: " + name);
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+/*
+ * State of one wait. Call Pause() after every failed check of the condition, or Wait(word, old)
+ * if the condition is a change of `word`: only the latter may park, and then the thread changing
+ * the word must call Notify().
+ */
+class Waiter {
+public:
+    explicit Waiter(WaitPolicy policy)
+            : Policy_(policy) {}
+
+    void Pause() {
+        switch (Policy_) {
+            case WaitPolicy::Spin:
+                CpuRelax();
+                break;
+            case WaitPolicy::Backoff:
+                for (unsigned i = 0; i < Backoff_; ++i)
+                    CpuRelax();
+                Backoff_ = std::min(Backoff_ * 2, MAX_BACKOFF);
+                break;
+            case WaitPolicy::Yield:
+            case WaitPolicy::Park:
+                if (++Spins_ < SPIN_LIMIT)
+                    CpuRelax();
+                else
+                    std::this_thread::yield();
+                break;
+        }
+    }
+
+    template <class T>
+    void Wait(const std::atomic<T>& word, T old) {
+        if (Policy_ == WaitPolicy::Park && ++Spins_ >= SPIN_LIMIT) {
+            word.wait(old, std::memory_order_acquire);
+            return;
+        }
+        Pause();
+    }
+
+    template <class T>
+    static void Notify(WaitPolicy policy, std::atomic<T>& word) {
+        if (policy == WaitPolicy::Park)
+            word.notify_all();
+    }
+
+private:
+    static constexpr unsigned SPIN_LIMIT = 128;
+    static constexpr unsigned MAX_BACKOFF = 1024;
+
+    WaitPolicy Policy_;
+    unsigned Spins_ = 0;
+    unsigned Backoff_ = 1;
+};
@@ -2,22 +2,132 @@
 
 #include "../DSU.h"
 
-#include <vector>
 #include <any>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * A request packed into 8 bytes: the op type is kept in the sign bit of `u`, which vertices never use.
+ */
+class Request {
+public:
+    Request() = default;
 
-struct Request {
-    bool SameSetRequest;
-    int u, v;
+    constexpr Request(bool sameSet, int u, int v)
+            : UOp_(uint32_t(u) | (sameSet ? SAME_SET_BIT : 0u))
+            , V_(v) {}
+
+    bool IsSameSet() const {
+        return UOp_ & SAME_SET_BIT;
+    }
+
+    int U() const {
+        return int(UOp_ & ~SAME_SET_BIT);
+    }
+
+    int V() const {
+        return V_;
+    }
 
     void Apply(DSU* dsu) const {
-        if (SameSetRequest) {
-            Blackhole(dsu->SameSet(u, v));
+        if (IsSameSet()) {
+            Blackhole(dsu->SameSet(U(), V()));
         } else {
-            dsu->Union(u, v);
+            dsu->Union(U(), V());
         }
     }
+
+private:
+    static constexpr uint32_t SAME_SET_BIT = 1u << 31;
+
+    uint32_t UOp_ = 0;
+    int V_ = 0;
+};
+
+static_assert(sizeof(Request) == 8);
+
+// how a worker thread holds its request stream during the measured run
+enum class RequestLayout {
+    AoS, // the Request array of the workload
+    SoA  // RequestColumns copied by the thread itself
 };
 
+inline std::string RequestLayoutName(RequestLayout layout) {
+    switch (layout) {
+        case RequestLayout::AoS: return "aos";
+        case RequestLayout::SoA: return "soa";
+    }
+    return "unknown";
+}
+
+inline RequestLayout ParseRequestLayout(const std::string& name) {
+    for (auto layout : {RequestLayout::AoS, RequestLayout::SoA}) {
+        if (RequestLayoutName(layout) == name)
+            return layout;
+    }
+    throw std::runtime_error("Unknown request layout: " + name);
+}
+
+/*
+ * Column layout of a request stream: separate `u` and `v` arrays and a bitmap of SameSet requests.
+ */
+class RequestColumns {
+public:
+    explicit RequestColumns(std::span<const Request> requests)
+            : U_(requests.size())
+            , V_(requests.size())
+            , SameSet_((requests.size() + 63) / 64, 0) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            U_[i] = requests[i].U();
+            V_[i] = requests[i].V();
+            SameSet_[i / 64] |= uint64_t(requests[i].IsSameSet()) << (i % 64);
+        }
+    }
+
+    class View;
+
+    View All() const;
+
+private:
+    std::vector<int> U_;
+    std::vector<int> V_;
+    std::vector<uint64_t> SameSet_;
+};
+
+// a range of RequestColumns with the part of the std::span interface the request loops use
+class RequestColumns::View {
+public:
+    View(const RequestColumns* columns, size_t offset, size_t count)
+            : Columns_(columns)
+            , Offset_(offset)
+            , Count_(count) {}
+
+    size_t size() const {
+        return Count_;
+    }
+
+    View subspan(size_t offset, size_t count) const {
+        return {Columns_, Offset_ + offset, count};
+    }
+
+    Request operator[](size_t i) const {
+        i += Offset_;
+        return {bool(Columns_->SameSet_[i / 64] >> (i % 64) & 1), Columns_->U_[i], Columns_->V_[i]};
+    }
+
+private:
+    const RequestColumns* Columns_;
+    size_t Offset_;
+    size_t Count_;
+};
+
+inline RequestColumns::View RequestColumns::All() const {
+    return {this, 0, U_.size()};
+}
+
 struct StaticWorkload {
     std::vector<Request> PreHeatRequests;
     std::vector<std::vector<Request>> ThreadRequests;
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "mst_engine.hpp"
+#include "../lib/node_partition.hpp"
+
+#include <atomic>
+#include <barrier>
+#include <numeric>
+#include <vector>
+
+
+/*
+ * Parallel Borůvka. In every round each thread scans its alive edges and proposes them to both roots
+ * in the best-edge array of its own node; then the node arrays are merged per root and the chosen edges are united.
+ */
+class BoruvkaMst : public MstEngine {
+public:
+    std::string_view Name() const override {
+        return "boruvka";
+    }
+
+    long long Run(NUMAContext* ctx, DSU* dsu, int n, std::span<const Edge> edges) override {
+        int numThreads = (int) ctx->MaxConcurrency();
+        NodePartition partition(ctx, numThreads, n);
+
+        std::vector<std::atomic<uint64_t>*> best(ctx->NodeCount(), nullptr);
+        for (int node : partition.ActiveNodes()) {
+            best[node] = (std::atomic<uint64_t>*) ctx->Allocate(node, sizeof(std::atomic<uint64_t>) * n);
+        }
+        std::vector<uint64_t> chosen(n);
+        std::vector<int> mates(n);
+        std::vector<long long> weights(numThreads, 0);
+        std::atomic<int> merges{0};
+        bool done = false;
+        std::barrier barrier(numThreads);
+        std::barrier roundBarrier(numThreads, [&]() noexcept {
+            done = merges.exchange(0) == 0;
+        });
+
+        ctx->StartNThreads([&]() {
+            int tid = NUMAContext::CurrentThreadId();
+            int node = NUMAContext::CurrentThreadNode();
+            auto [begin, end] = partition.Chunk(tid);
+            auto [edgeBegin, edgeEnd] = NodePartition::Split(0, (int) edges.size(), tid, numThreads);
+            std::vector<int> alive(edgeEnd - edgeBegin);
+            std::iota(alive.begin(), alive.end(), edgeBegin);
+
+            std::atomic<uint64_t>* localBest = best[node];
+            auto [initBegin, initEnd] = NodePartition::Split(0, n, partition.LocalIndex(tid),
+                                                             (int) partition.NodeThreads(node).size());
+            for (int u = initBegin; u < initEnd; ++u) {
+                localBest[u].store(NONE, std::memory_order_relaxed);
+            }
+            barrier.arrive_and_wait();
+
+            while (true) {
+                size_t kept = 0;
+                for (int i : alive) {
+                    auto [ru, rv] = dsu->FindPair(edges[i].u, edges[i].v);
+                    if (ru == rv)
+                        continue;
+                    alive[kept++] = i;
+                    uint64_t key = EdgeKey(edges, i);
+                    proposeMin(localBest[ru], key);
+                    proposeMin(localBest[rv], key);
+                }
+                alive.resize(kept);
+                barrier.arrive_and_wait();
+
+                for (int r = begin; r < end; ++r) {
+                    uint64_t key = NONE;
+                    for (int oth : partition.ActiveNodes()) {
+                        if (best[oth][r].load(std::memory_order_relaxed) != NONE)
+                            key = std::min(key, best[oth][r].exchange(NONE, std::memory_order_relaxed));
+                    }
+                    chosen[r] = key;
+                    if (key != NONE) {
+                        const Edge& e = edges[EdgeKeyIndex(key)];
+                        auto [ru, rv] = dsu->FindPair(e.u, e.v);
+                        mates[r] = ru == r ? rv : ru;
+                    }
+                }
+                barrier.arrive_and_wait();
+
+                int localMerges = 0;
+                for (int r = begin; r < end; ++r) {
+                    if (chosen[r] == NONE)
+                        continue;
+                    int mate = mates[r];
+                    if (chosen[mate] == chosen[r] && mate < r)
+                        continue; // both roots chose the edge; the smaller one unites
+                    const Edge& e = edges[EdgeKeyIndex(chosen[r])];
+                    dsu->Union(e.u, e.v);
+                    weights[tid] += e.w;
+                    ++localMerges;
+                }
+                merges.fetch_add(localMerges);
+                roundBarrier.arrive_and_wait();
+                if (done)
+                    break;
+            }
+        }, numThreads);
+        ctx->Join();
+
+        for (int node : partition.ActiveNodes()) {
+            ctx->Free(best[node], sizeof(std::atomic<uint64_t>) * n);
+        }
+        return std::accumulate(weights.begin(), weights.end(), 0ll);
+    }
+
+private:
+    static void proposeMin(std::atomic<uint64_t>& slot, uint64_t key) {
+        uint64_t cur = slot.load(std::memory_order_relaxed);
+        while (key < cur && !slot.compare_exchange_weak(cur, key, std::memory_order_relaxed)) {}
+    }
+
+    static constexpr uint64_t NONE = ~0ull;
+};
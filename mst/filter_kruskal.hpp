@@ -0,0 +1,116 @@
+#pragma once
+
+#include "mst_engine.hpp"
+#include "../lib/node_partition.hpp"
+#include "../lib/util.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <random>
+#include <vector>
+
+
+/*
+ * Parallel Filter-Kruskal. Edges are sample-sorted into weight buckets in parallel;
+ * buckets are processed in order: all threads drop the edges of a bucket that are already inside a set,
+ * then the survivors are sorted and united by Kruskal on a single thread.
+ */
+class FilterKruskalMst : public MstEngine {
+public:
+    std::string_view Name() const override {
+        return "filter-kruskal";
+    }
+
+    long long Run(NUMAContext* ctx, DSU* dsu, int n, std::span<const Edge> edges) override {
+        if (edges.empty())
+            return 0;
+
+        int numThreads = (int) ctx->MaxConcurrency();
+        std::vector<uint64_t> splitters(NUM_BUCKETS - 1);
+        std::vector<int> offsets(numThreads * NUM_BUCKETS, 0); // per-thread bucket counts at first
+        std::vector<int> bucketBegin(NUM_BUCKETS + 1);
+        std::vector<int> order(edges.size());
+        std::vector<std::vector<int>> survivors(numThreads);
+        long long weight = 0;
+        int mstEdges = 0;
+        std::barrier barrier(numThreads);
+
+        ctx->StartNThreads([&]() {
+            int tid = NUMAContext::CurrentThreadId();
+            auto [edgeBegin, edgeEnd] = NodePartition::Split(0, (int) edges.size(), tid, numThreads);
+            auto bucketOf = [&](int i) {
+                return (int) (std::upper_bound(splitters.begin(), splitters.end(), EdgeKey(edges, i)) - splitters.begin());
+            };
+
+            if (tid == 0) {
+                std::vector<uint64_t> sample(NUM_SAMPLES);
+                std::uniform_int_distribution<int> distribution(0, (int) edges.size() - 1);
+                for (auto& key : sample) {
+                    key = EdgeKey(edges, distribution(TlRandom));
+                }
+                std::sort(sample.begin(), sample.end());
+                for (int b = 0; b + 1 < NUM_BUCKETS; ++b) {
+                    splitters[b] = sample[(b + 1) * NUM_SAMPLES / NUM_BUCKETS];
+                }
+            }
+            barrier.arrive_and_wait();
+
+            for (int i = edgeBegin; i < edgeEnd; ++i) {
+                ++offsets[tid * NUM_BUCKETS + bucketOf(i)];
+            }
+            barrier.arrive_and_wait();
+
+            if (tid == 0) {
+                int pos = 0;
+                for (int b = 0; b < NUM_BUCKETS; ++b) {
+                    bucketBegin[b] = pos;
+                    for (int t = 0; t < numThreads; ++t) {
+                        pos += std::exchange(offsets[t * NUM_BUCKETS + b], pos);
+                    }
+                }
+                bucketBegin[NUM_BUCKETS] = pos;
+            }
+            barrier.arrive_and_wait();
+
+            for (int i = edgeBegin; i < edgeEnd; ++i) {
+                order[offsets[tid * NUM_BUCKETS + bucketOf(i)]++] = i;
+            }
+            barrier.arrive_and_wait();
+
+            for (int b = 0; b < NUM_BUCKETS && mstEdges < n - 1; ++b) {
+                auto [filterBegin, filterEnd] = NodePartition::Split(bucketBegin[b], bucketBegin[b + 1], tid, numThreads);
+                auto& local = survivors[tid];
+                local.clear();
+                for (int k = filterBegin; k < filterEnd; ++k) {
+                    int i = order[k];
+                    if (mstEdges == 0 || !dsu->SameSet(edges[i].u, edges[i].v))
+                        local.push_back(i);
+                }
+                barrier.arrive_and_wait();
+
+                if (tid == 0) {
+                    std::vector<int> bucket;
+                    for (const auto& part : survivors) {
+                        bucket.insert(bucket.end(), part.begin(), part.end());
+                    }
+                    std::sort(bucket.begin(), bucket.end(), [&edges](int i, int j) {
+                        return EdgeKey(edges, i) < EdgeKey(edges, j);
+                    });
+                    for (int i : bucket) {
+                        if (dsu->TryUnion(edges[i].u, edges[i].v).merged) {
+                            weight += edges[i].w;
+                            ++mstEdges;
+                        }
+                    }
+                }
+                barrier.arrive_and_wait();
+            }
+        }, numThreads);
+        ctx->Join();
+        return weight;
+    }
+
+private:
+    static constexpr int NUM_BUCKETS = 64;
+    static constexpr int NUM_SAMPLES = 64 * NUM_BUCKETS;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../DSU.h"
+#include "../lib/graphs.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+
+class MstEngine {
+public:
+    virtual std::string_view Name() const = 0;
+
+    /*
+     * Builds a minimum spanning forest in the given (fresh) DSU using every worker thread of the context
+     * and returns its weight. Must be called outside of the worker threads.
+     */
+    virtual long long Run(NUMAContext* ctx, DSU* dsu, int n, std::span<const Edge> edges) = 0;
+
+    virtual ~MstEngine() = default;
+
+protected:
+    // edges are ordered by (weight, index), so the minimum spanning forest is unique
+    static uint64_t EdgeKey(std::span<const Edge> edges, int i) {
+        return (static_cast<uint64_t>(edges[i].w) << 32) | static_cast<uint32_t>(i);
+    }
+
+    static int EdgeKeyIndex(uint64_t key) {
+        return static_cast<int>(key & 0xFFFFFFFFu);
+    }
+};
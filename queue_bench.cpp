@@ -0,0 +1,254 @@
+#include "lib/stats.hpp"
+#include "lib/csv.hpp"
+#include "lib/parameters.hpp"
+#include "lib/pair_queue.hpp"
+
+// The vendored queues use GNU statement expressions (LCRQueue.hpp).
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include "utils/ConcurrencyFreaks/queues/MichaelScottQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/LCRQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/CRTurnQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/KoganPetrankQueueCHP.hpp"
+#include "utils/ConcurrencyFreaks/queues/BitNextQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/BitNextLazyHeadQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/CRDoubleLinkQueue.hpp"
+#include "utils/ConcurrencyFreaks/queues/array/FAAArrayQueue.hpp"
+#pragma GCC diagnostic pop
+
+#include <CLI/App.hpp>
+#include <CLI/Formatter.hpp>
+#include <CLI/Config.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <regex>
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <limits>
+
+
+const std::vector<std::string> PARAMETER_NAMES = {"producers", "consumers", "ops", "placement"};
+
+constexpr size_t LATENCY_SAMPLE_PERIOD = 64; // every k-th item of a producer is timed
+
+/*
+ * Thread roles for a placement. The queue lives on node 0, consumers run on node 0, and producers run
+ *  - local: on node 0 as well;
+ *  - remote: on the last node;
+ *  - spread: round-robin on all nodes (fan-in of delegated requests).
+ */
+struct Placement {
+    std::vector<int> Producers; // thread ids
+    std::vector<int> Consumers;
+    int QueueNode = 0;
+
+    int NumThreads() const {
+        int maxTid = -1;
+        for (int tid : Producers)
+            maxTid = std::max(maxTid, tid);
+        for (int tid : Consumers)
+            maxTid = std::max(maxTid, tid);
+        return maxTid + 1;
+    }
+};
+
+Placement MakePlacement(const NUMAContext* ctx, const std::string& placement, int producers, int consumers) {
+    int nodeCount = (int) ctx->NodeCount();
+    std::vector<std::vector<int>> nodeThreads(nodeCount);
+    for (int tid = 0; tid < (int) ctx->MaxConcurrency(); ++tid) {
+        nodeThreads[ctx->NumaNodeForThread(tid)].push_back(tid);
+    }
+    std::vector<size_t> used(nodeCount, 0);
+    auto take = [&](int node) {
+        REQUIRE(used[node] < nodeThreads[node].size(), "Not enough CPUs on node " + std::to_string(node));
+        return nodeThreads[node][used[node]++];
+    };
+
+    Placement res;
+    for (int i = 0; i < consumers; ++i) {
+        res.Consumers.push_back(take(0));
+    }
+    for (int i = 0; i < producers; ++i) {
+        if (placement == "local") {
+            res.Producers.push_back(take(0));
+        } else if (placement == "remote") {
+            res.Producers.push_back(take(nodeCount - 1));
+        } else if (placement == "spread") {
+            res.Producers.push_back(take(i % nodeCount));
+        } else {
+            REQUIRE(false, "Invalid placement: " + placement);
+        }
+    }
+    return res;
+}
+
+void atomicMin(std::atomic<int64_t>& x, int64_t value) {
+    int64_t cur = x.load(std::memory_order_relaxed);
+    while (value < cur && !x.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+void atomicMax(std::atomic<int64_t>& x, int64_t value) {
+    int64_t cur = x.load(std::memory_order_relaxed);
+    while (value > cur && !x.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+struct QueueRunResult {
+    double Throughput; // items per second
+    std::vector<uint32_t> Latencies; // ns from Push to TryPop of the sampled items
+};
+
+template <template <class> class Q>
+QueueRunResult RunQueueOnce(NUMAContext* ctx, const Placement& placement, size_t ops) {
+    constexpr size_t NS = 1'000'000'000ull;
+    PairQueue<Q> queue(ctx, placement.QueueNode);
+    int numProducers = (int) placement.Producers.size();
+    int numConsumers = (int) placement.Consumers.size();
+    size_t total = ops * numProducers;
+
+    std::vector<std::vector<int64_t>> pushedAt(numProducers, std::vector<int64_t>((ops + LATENCY_SAMPLE_PERIOD - 1) / LATENCY_SAMPLE_PERIOD));
+    std::vector<std::vector<uint32_t>> latencies(numConsumers);
+    std::atomic<size_t> consumed{0};
+    std::barrier barrier(numProducers + numConsumers);
+    // the run lasts from the first start to the last consumed item
+    std::atomic<int64_t> startedAt{std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> finishedAt{0};
+    auto now = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+    ctx->StartNThreads([&]() {
+        int tid = NUMAContext::CurrentThreadId();
+        auto producer = std::find(placement.Producers.begin(), placement.Producers.end(), tid);
+        auto consumer = std::find(placement.Consumers.begin(), placement.Consumers.end(), tid);
+        if (producer != placement.Producers.end()) {
+            int p = (int) (producer - placement.Producers.begin());
+            ctx->PreferNode(queue.Node());
+            barrier.arrive_and_wait();
+            atomicMin(startedAt, now());
+            for (size_t seq = 0; seq < ops; ++seq) {
+                if (seq % LATENCY_SAMPLE_PERIOD == 0)
+                    pushedAt[p][seq / LATENCY_SAMPLE_PERIOD] = now();
+                queue.Push(p, (int) seq);
+            }
+        } else if (consumer != placement.Consumers.end()) {
+            auto& samples = latencies[consumer - placement.Consumers.begin()];
+            barrier.arrive_and_wait();
+            atomicMin(startedAt, now());
+            int p, seq;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (!queue.TryPop(p, seq))
+                    continue;
+                if (seq % LATENCY_SAMPLE_PERIOD == 0)
+                    samples.push_back((uint32_t) (now() - pushedAt[p][seq / LATENCY_SAMPLE_PERIOD]));
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+            atomicMax(finishedAt, now());
+        }
+    }, placement.NumThreads());
+    ctx->Join();
+
+    int64_t duration = finishedAt.load() - startedAt.load();
+    QueueRunResult res{(double) total * NS / std::max<int64_t>(duration, 1), {}};
+    for (const auto& samples : latencies)
+        res.Latencies.insert(res.Latencies.end(), samples.begin(), samples.end());
+    return res;
+}
+
+/*
+ * Score is the number of pairs passed through the queue per second; latency rows are in ns.
+ */
+template <template <class> class Q>
+void RunQueueBenchmark(NUMAContext* ctx, CsvFile& out, const std::regex& filter,
+                       size_t numIterations, const ParameterSet& params) {
+    std::string name = PairQueue<Q>(ctx, 0).Name();
+    if (!std::regex_match(name, filter))
+        return;
+    Placement placement = MakePlacement(ctx, params.Get<std::string>("placement"),
+                                        params.Get<int>("producers"), params.Get<int>("consumers"));
+    size_t ops = params.Get<size_t>("ops");
+
+    std::vector<double> throughputs;
+    std::vector<double> p50, p99;
+    for (size_t j = 0; j <= numIterations; ++j) {
+        std::cout << (j == 0 ? "Warmup iteration" : "Benchmark iteration #" + std::to_string(j - 1))
+                  << "; queue " << name << std::endl;
+        QueueRunResult r = RunQueueOnce<Q>(ctx, placement, ops);
+        if (j == 0)
+            continue;
+        throughputs.push_back(r.Throughput);
+        p50.push_back(quantile(r.Latencies, 0.5));
+        p99.push_back(quantile(r.Latencies, 0.99));
+    }
+
+    Stats<double> result = stats(throughputs.begin(), throughputs.end());
+    std::cout << std::fixed << std::setprecision(3)
+              << name << ": " << result.mean << "+-" << result.stddev << std::endl;
+    for (auto [metric, values] : {std::pair{"", &throughputs}, std::pair{":latency_p50_ns", &p50}, std::pair{":latency_p99_ns", &p99}}) {
+        Stats<double> s = stats(values->begin(), values->end());
+        auto writer = out << (name + metric);
+        for (const std::string& param : PARAMETER_NAMES) {
+            writer << params.Get<std::string>(param);
+        }
+        writer << s.mean << s.stddev;
+    }
+}
+
+
+int main(int argc, const char* argv[]) {
+    CLI::App app("NUMA placement benchmark of the vendored concurrent queues");
+
+    std::vector<std::string> rawParameters;
+    app.add_option("-p,--param", rawParameters, "Parameter in the form key=val1,val2,...,valN");
+
+    bool testing = false;
+    app.add_flag("--testing", testing, "Setup NUMA context for testing with 8 CPUs on 4 nodes");
+
+    std::string queueFilter = ".*";
+    app.add_option("-q,--queue", queueFilter, "ECMAScript regular expression specifying queues to benchmark");
+
+    std::string outFileName = "queues.csv";
+    app.add_option("-o,--out", outFileName, "Output CSV file");
+
+    size_t numIterations = 3;
+    app.add_option("-i,--num-iterations", numIterations, "Number of iterations per parameter set");
+
+    CLI11_PARSE(app, argc, argv);
+
+    ParameterSet defaults = ParseParameters({
+        "producers=2",
+        "consumers=1", // 1 for MPSC
+        "ops=1000000", // pairs per producer
+        "placement=local" // local, remote or spread
+    })[0];
+    auto parameters = ParseParameters(rawParameters, &defaults);
+    auto filter = std::regex(queueFilter, std::regex::ECMAScript | std::regex::icase | std::regex::nosubs);
+
+    NUMAContext ctx(4);
+    if (testing) {
+        ctx.SetupForTests(8, 4);
+    }
+
+    CsvFile out(outFileName);
+    { // write CSV header
+        auto writer = out << "Queue";
+        for (const std::string& param : PARAMETER_NAMES) {
+            writer << param;
+        }
+        writer << "Score" << "Score Error";
+    }
+
+    for (const auto& params : parameters) {
+        RunQueueBenchmark<MichaelScottQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<FAAArrayQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<LCRQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<CRTurnQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<KoganPetrankQueueCHP>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<BitNextQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<BitNextLazyHeadQueue>(&ctx, out, filter, numIterations, params);
+        RunQueueBenchmark<CRDoubleLinkQueue>(&ctx, out, filter, numIterations, params);
+    }
+    return 0;
+}
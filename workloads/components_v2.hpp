@@ -3,6 +3,7 @@
 #include "../lib/workload_provider.hpp"
 #include "../lib/util.hpp"
 
+#include <numeric>
 #include <random>
 
 
@@ -14,9 +15,17 @@ public:
         double interpairFraction = params.Get<double>("ipf");
         double sameSetFraction = params.Get<double>("ssf");
         bool shuffleVertices = params.Get<bool>("shuffle");
-        return BuildComponentsRandomWorkloadV2(ctx->MaxConcurrency(), ctx->NodeCount(), N, E,
-                                               interpairFraction, sameSetFraction,
-                                               [ctx](int tid) { return ctx->NumaNodeForThread(tid); }, shuffleVertices);
+        double preheatFraction = params.Get<double>("preheat");
+
+        // one component per node whatever the worker count, so runs with different thread counts get the same graph
+        size_t numThreads = ctx->WorkerCount();
+        std::vector<int> componentNodes(ctx->NodeCount());
+        std::iota(componentNodes.begin(), componentNodes.end(), 0);
+        return BuildComponentsRandomWorkloadV2(numThreads, componentNodes, N, E,
+                                               interpairFraction, sameSetFraction, preheatFraction,
+                                               [ctx](int tid) {
+                                                   return ctx->NumaNodeForThread(tid);
+                                               }, shuffleVertices);
     }
 
     void PrepareSeries() override {
@@ -35,7 +44,7 @@ public:
 
     std::vector<std::string> GetParameterNames() const override {
         return {
-            "N", "E", "ipf", "ssf", "shuffle"
+            "N", "E", "ipf", "ssf", "shuffle", "preheat"
         };
     }
 
@@ -45,20 +54,28 @@ public:
                "E=64000000",
                "ipf=0.2",
                "ssf=0.1",
-               "shuffle=true"
+               "shuffle=true",
+               "preheat=0" // fraction of requests whose unions are bulk-built before the measured run
        }, commonDefaults)[0];
     }
 
 private:
-    StaticWorkload BuildComponentsRandomWorkloadV2(size_t numThreads, size_t numComponents, size_t N, size_t E,
+    /*
+     * Component c is owned by node componentNodes[c]; threadNodeLayout(tid) is the component of the thread.
+     * The internal edges of a component are split between its threads, or between all threads if it has none.
+     */
+    StaticWorkload BuildComponentsRandomWorkloadV2(size_t numThreads, const std::vector<int>& componentNodes,
+                                                   size_t N, size_t E,
                                                    double intercomponentEFraction, double sameSetFraction,
-                                                   auto threadNodeLayout, bool shuffle) {
+                                                   double preheatFraction, auto threadNodeLayout, bool shuffle) {
         // E is the number of union requests
         // so we transform to the number of all requests
         E = static_cast<size_t>(std::round(E / (1. - sameSetFraction)));
 
-        REQUIRE(numThreads % numComponents == 0, "Number of threads must be divisible by number of components");
-        REQUIRE(numComponents > 1, "Number of components must be greater than 1");
+        size_t numComponents = componentNodes.size();
+        REQUIRE(numThreads > 0 && numComponents > 0, "No worker threads");
+        if (numComponents == 1) // nothing to connect
+            intercomponentEFraction = 0;
 
         // assign a component # tid/numComponents to each thread
         // independently generate random edges for each thread inside the component
@@ -67,7 +84,7 @@ private:
         size_t componentN = N / numComponents;
         size_t intercomponentE = std::round(intercomponentEFraction * E);
         size_t internalE = E - intercomponentE;
-        size_t internalThreadE = internalE / numThreads;
+        size_t internalComponentE = internalE / numComponents;
 
         std::vector<int> vertexPermutation;
         if (useSeries_ && seriesVertexPermutation_.size() == numComponents * componentN) {
@@ -88,20 +105,28 @@ private:
         std::vector<int> componentMapping(numComponents * componentN);
         for (size_t i = 0; i < vertexPermutation.size(); ++i) {
             size_t expId = i * numComponents / N;
-            componentMapping[vertexPermutation[i]] = (int) expId;
+            componentMapping[vertexPermutation[i]] = componentNodes[expId];
         }
 
         std::bernoulli_distribution sameSetDistribution(sameSetFraction);
         std::vector<std::vector<Request>> threadWork(numThreads);
 
+        std::vector<std::vector<size_t>> componentThreads(numComponents);
         for (size_t tid = 0; tid < numThreads; ++tid) {
-            size_t componentId = threadNodeLayout(tid);
+            componentThreads[threadNodeLayout(tid)].push_back(tid);
+        }
+        for (size_t componentId = 0; componentId < numComponents; ++componentId) {
+            auto& threads = componentThreads[componentId];
+            if (threads.empty()) {
+                threads.resize(numThreads);
+                std::iota(threads.begin(), threads.end(), 0);
+            }
             size_t minComponentVertex = componentN * componentId;
             std::uniform_int_distribution<int> uvDistribution(minComponentVertex, minComponentVertex + componentN - 1);
-            for (size_t i = 0; i < internalThreadE; ++i) {
+            for (size_t i = 0; i < internalComponentE; ++i) {
                 int u = uvDistribution(TlRandom);
                 int v = uvDistribution(TlRandom);
-                threadWork[tid].push_back({
+                threadWork[threads[i % threads.size()]].push_back({
                       sameSetDistribution(TlRandom),
                       vertexPermutation[u],
                       vertexPermutation[v]
@@ -110,7 +135,7 @@ private:
         }
 
         std::vector<Request> interpairRequests;
-        size_t interPairE = intercomponentE / ((numComponents - 1) * numComponents / 2);
+        size_t interPairE = intercomponentE / std::max<size_t>((numComponents - 1) * numComponents / 2, 1);
         for (size_t c1 = 0; c1 < numComponents; ++c1) {
             size_t minC1Vertex = componentN * c1;
             std::uniform_int_distribution<int> uDistribution(minC1Vertex, minC1Vertex + componentN - 1);
@@ -143,8 +168,18 @@ private:
         for (auto& work: threadWork) {
             Shuffle(work);
         }
+
+        // unions from the head of every thread's work form the preheat
+        std::vector<Request> preheatRequests;
+        for (auto& work: threadWork) {
+            auto split = work.begin() + (ptrdiff_t) std::round(preheatFraction * (double) work.size());
+            std::copy_if(work.begin(), split, std::back_inserter(preheatRequests), [](const Request& r) {
+                return !r.IsSameSet();
+            });
+            work.erase(work.begin(), split);
+        }
         return StaticWorkload{
-                {},
+                std::move(preheatRequests),
                 std::move(threadWork),
                 numComponents * componentN,
                 {ComponentMappingMd{std::move(componentMapping)}}
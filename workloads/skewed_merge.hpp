@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../lib/workload_provider.hpp"
+#include "../lib/util.hpp"
+#include "../lib/node_partition.hpp"
+
+#include <random>
+
+
+/*
+ * Everybody merges into one giant component: a `skew` fraction of unions attaches a vertex
+ * of the thread's own node to one of a few `hubs` scattered over all nodes; the rest connect
+ * random vertices of the thread's node. The roots of the giant component are contended by all threads.
+ */
+class SkewedMergeWorkload : public WorkloadProvider {
+public:
+    StaticWorkload MakeWorkload(NUMAContext* ctx, const ParameterSet& params) override {
+        size_t numThreads = ctx->WorkerCount();
+        size_t N = params.Get<size_t>("N");
+        double sameSetFraction = params.Get<double>("ssf");
+        size_t E = static_cast<size_t>(std::round(params.Get<size_t>("E") / (1. - sameSetFraction)));
+        size_t numHubs = params.Get<size_t>("hubs");
+        double skew = params.Get<double>("skew");
+        REQUIRE(numHubs > 0 && numHubs <= N, "Number of hubs must be in [1, N]");
+
+        // vertices are split into blocks of the nodes running workers; the permutation hides the block structure from the DSU
+        NodePartition partition(ctx, (int) numThreads, (int) N);
+        std::vector<int> vertexPermutation(N);
+        std::generate(vertexPermutation.begin(), vertexPermutation.end(), [i = 0]() mutable {
+            return i++;
+        });
+        if (params.Get<bool>("shuffle")) {
+            Shuffle(vertexPermutation);
+        }
+        std::vector<int> componentMapping(N);
+        for (int node : partition.ActiveNodes()) {
+            auto [begin, end] = partition.Block(node);
+            for (int i = begin; i < end; ++i) {
+                componentMapping[vertexPermutation[i]] = node;
+            }
+        }
+
+        std::vector<int> hubs(numHubs);
+        std::uniform_int_distribution<int> anyVertex(0, (int) N - 1);
+        for (int& hub : hubs) {
+            hub = anyVertex(TlRandom);
+        }
+
+        std::bernoulli_distribution sameSetDistribution(sameSetFraction);
+        std::bernoulli_distribution hubDistribution(skew);
+        std::uniform_int_distribution<size_t> hubIndex(0, numHubs - 1);
+        std::vector<std::vector<Request>> threadWork(numThreads);
+        for (size_t tid = 0; tid < numThreads; ++tid) {
+            auto [begin, end] = partition.Block(ctx->NumaNodeForThread((int) tid));
+            std::uniform_int_distribution<int> nodeVertex(begin, end - 1);
+            for (size_t i = 0; i < E / numThreads; ++i) {
+                int u = vertexPermutation[nodeVertex(TlRandom)];
+                int v = hubDistribution(TlRandom) ? hubs[hubIndex(TlRandom)] : vertexPermutation[nodeVertex(TlRandom)];
+                threadWork[tid].push_back({sameSetDistribution(TlRandom), u, v});
+            }
+        }
+
+        return StaticWorkload{
+                {},
+                std::move(threadWork),
+                N,
+                {ComponentMappingMd{std::move(componentMapping)}}
+        };
+    }
+
+    std::string_view Name() const override {
+        return "skewed";
+    }
+
+    std::vector<std::string> GetParameterNames() const override {
+        return {
+            "N", "E", "ssf", "hubs", "skew", "shuffle"
+        };
+    }
+
+    ParameterSet GetDefaultParameters(const ParameterSet* commonDefaults) const override {
+        return ParseParameters({
+               "N=4000000",
+               "E=64000000",
+               "ssf=0.1",
+               "hubs=16",
+               "skew=0.5", // fraction of unions attached to a hub
+               "shuffle=true"
+       }, commonDefaults)[0];
+    }
+};